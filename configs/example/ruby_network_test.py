@@ -58,7 +58,31 @@ parser.add_option("--synthetic", type="int", default=0,
                         5 = Neighbor\
                         6 = Shuffle\
                         7 = Transpose\
-                        ")
+                        8 = Hotspot\
+                        9 = All-to-all\
+                        10 = Incast\
+                        11 = Stride\
+                        12 = Random Permutation\
+                        13 = Mesh Tornado\
+                        14 = Mesh Bit Complement\
+                        15 = Mesh Neighbor\
+                        16 = Mesh Transpose\
+                        (1-7 on node ids, 13-16 on square 2D mesh \
+                        coordinates)")
+
+parser.add_option("--hotspot-fraction", type="float", default=0.5,
+                  help="Fraction of the hotspot traffic sent to \
+                        --target-dest-id")
+
+parser.add_option("--target-dest-id", type="int", default=0,
+                  help="Destination of the hotspot and incast traffic")
+
+parser.add_option("--stride", type="int", default=1,
+                  help="Distance between source and destination of the \
+                        stride traffic")
+
+parser.add_option("--pattern-seed", type="int", default=1,
+                  help="Seed of the random permutation traffic")
 
 parser.add_option("-i", "--injectionrate", type="float", default=0.1,
                   metavar="I",
@@ -66,6 +90,20 @@ parser.add_option("-i", "--injectionrate", type="float", default=0.1,
                         Takes decimal value between 0 to 1 (eg. 0.225). \
                         Number of digits after 0 depends upon --precision.")
 
+parser.add_option("--arrival", type="choice", default="bernoulli",
+                  choices=["bernoulli", "geometric", "exponential"],
+                  help="Packet arrival process: bernoulli polls every \
+                        cycle, geometric is the same process with one \
+                        event per packet, exponential is Poisson")
+
+parser.add_option("--burst-on-cycles", type="float", default=0,
+                  help="Mean length of the on periods of on/off bursty \
+                        traffic, in cycles (0: not bursty)")
+
+parser.add_option("--burst-off-cycles", type="float", default=0,
+                  help="Mean length of the off periods of on/off bursty \
+                        traffic, in cycles")
+
 parser.add_option("--precision", type="int", default=3,
                   help="Number of digits of precision after decimal point\
                         for injection rate")
@@ -82,6 +120,32 @@ parser.add_option("--single-sender-id", type="int", default=-1,
 parser.add_option("--single-dest-id", type="int", default=-1,
                   help="Only send to this destination")
 
+parser.add_option("--sweep", action="store_true", default=False,
+                  help="Sweep the injection rate within one simulation \
+                        and write a latency vs offered load table to \
+                        injection_sweep.txt in the output directory")
+
+parser.add_option("--sweep-start", type="float", default=0.02,
+                  help="First injection rate of the sweep")
+
+parser.add_option("--sweep-step", type="float", default=0.02,
+                  help="Injection rate increment of the sweep")
+
+parser.add_option("--sweep-end", type="float", default=1.0,
+                  help="Last injection rate of the sweep")
+
+parser.add_option("--sweep-warmup-cycles", type="int", default=2000,
+                  help="Cycles simulated at each injection rate before \
+                        stats are reset")
+
+parser.add_option("--sweep-measure-cycles", type="int", default=10000,
+                  help="Cycles measured at each injection rate")
+
+parser.add_option("--sweep-saturation", type="float", default=3.0,
+                  help="Stop the sweep once the average packet latency \
+                        exceeds this multiple of the latency at the \
+                        first injection rate")
+
 #
 # Add the ruby specific and protocol specific options
 #
@@ -103,12 +167,24 @@ if options.num_cpus > block_size:
      sys.exit(1)
 
 
+# A sweep runs for as long as it needs to
+if options.sweep:
+     options.sim_cycles = 2**31 - 1
+     options.injectionrate = options.sweep_start
+
 cpus = [ NetworkTest(num_packets_max=options.num_packets_max,
                      single_sender=options.single_sender_id,
                      single_dest=options.single_dest_id,
                      sim_cycles=options.sim_cycles,
                      traffic_type=options.synthetic,
+                     hotspot_fraction=options.hotspot_fraction,
+                     target_dest=options.target_dest_id,
+                     stride=options.stride,
+                     pattern_seed=options.pattern_seed,
                      inj_rate=options.injectionrate,
+                     arrival=options.arrival,
+                     burst_on_cycles=options.burst_on_cycles,
+                     burst_off_cycles=options.burst_off_cycles,
                      precision=options.precision,
                      num_memories=options.num_dirs) \
          for i in xrange(options.num_cpus) ]
@@ -135,6 +211,10 @@ for ruby_port in system.ruby._cpu_ports:
      # Tie the cpu test ports to the ruby cpu port
      #
      cpus[i].test = ruby_port.slave
+     # the tester calls into the sequencer, so it has to share the event
+     # queue of the sequencer's controller
+     if options.network_partitions > 1:
+          cpus[i].eventq_index = ruby_port._parent.eventq_index
      i += 1
 
 # -----------------------
@@ -147,10 +227,81 @@ root.system.mem_mode = 'timing'
 # Not much point in this being higher than the L1 latency
 m5.ticks.setGlobalFrequency('1ns')
 
+# The partitions of the network synchronize every link latency, at
+# least one Ruby cycle (1 tick = 1ns)
+if options.network_partitions > 1:
+     root.sim_quantum = max(1, int(round(
+          m5.util.convert.anyToLatency(options.ruby_clock) * 1e9)))
+
 # instantiate configuration
 m5.instantiate()
 
-# simulate until program terminates
-exit_event = m5.simulate(options.abs_max_tick)
-
-print 'Exiting @ tick', m5.curTick(), 'because', exit_event.getCause()
+def network_stats():
+     """ Network stats of the last stats dump """
+     stats_file = os.path.join(m5.options.outdir, m5.options.stats_file)
+     lines = open(stats_file).read().split("Begin Simulation Statistics")[-1]
+     stats = {}
+     for line in lines.splitlines():
+          fields = line.split()
+          if len(fields) >= 2 and \
+             fields[0].startswith("system.ruby.network."):
+               stats[fields[0][len("system.ruby.network."):]] = fields[1]
+     return stats
+
+def run_sweep():
+     """ Step the injection rate within this simulation. At each step the
+         network is warmed up, the stats are reset, and one measurement
+         period is simulated and dumped. The tester runs one cycle per
+         tick (1ns), as --sim-cycles assumes.
+     """
+     table = open(os.path.join(m5.options.outdir, "injection_sweep.txt"), "w")
+     table.write("# injection_rate accepted_rate average_packet_latency "
+                 "p99_packet_latency deflection_rate\n")
+
+     zero_load_latency = None
+     step = 0
+     while True:
+          rate = options.sweep_start + step * options.sweep_step
+          if rate > options.sweep_end + 1e-9:
+               break
+          for cpu in cpus:
+               cpu.setInjRate(rate)
+
+          m5.simulate(options.sweep_warmup_cycles)
+          m5.stats.reset()
+          exit_event = m5.simulate(options.sweep_measure_cycles)
+          if exit_event.getCause() != "simulate() limit reached":
+               return exit_event
+          m5.stats.dump()
+
+          stats = network_stats()
+          received = float(stats.get("packets_received::total", 0))
+          latency = float(stats.get("average_packet_latency", "nan"))
+          p99 = float(stats.get("packet_latency_p99", "nan"))
+          # only with deflection routers
+          deflection = float(stats.get("deflection_rate", "nan"))
+          accepted = received / (len(cpus) * options.sweep_measure_cycles)
+          table.write("%f %f %f %f %f\n" %
+                      (rate, accepted, latency, p99, deflection))
+          table.flush()
+          print "Injection rate %f: accepted %f, latency %f" % \
+                (rate, accepted, latency)
+
+          if received > 0:
+               if zero_load_latency is None:
+                    zero_load_latency = latency
+               elif latency > options.sweep_saturation * zero_load_latency:
+                    print "Network saturated at injection rate", rate
+                    break
+          step += 1
+
+     return None
+
+if options.sweep:
+     exit_event = run_sweep()
+else:
+     # simulate until program terminates
+     exit_event = m5.simulate(options.abs_max_tick)
+
+if exit_event:
+     print 'Exiting @ tick', m5.curTick(), 'because', exit_event.getCause()
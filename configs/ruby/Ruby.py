@@ -73,12 +73,44 @@ def define_options(parser):
                       choices=['simple', 'garnet-fixed-pipeline', 'garnet2.0'], help="'simple' | 'garnet1.0'|'garnet2.0'")
     parser.add_option("--num-pipe-stages", action="store", type="int", default=5,
                       help="number of pipeline stages in the garnet router. Has to be >= 1.")
+    parser.add_option("--router-model", type="choice", default="vc",
+                      choices=['vc', 'deflection'],
+                      help="garnet2.0 router: 'vc' (input-buffered, virtual channels) | 'deflection' (bufferless).")
     parser.add_option("--channel-width-bits", action="store", type="int", default=128,
                       help="channel width in bits for all links inside garnet network.")
+    parser.add_option("--ext-link-width", action="store", type="int", default=0,
+                      help="width in bytes of the garnet2.0 links to the controllers (hosts), which serialize flits wider than them (0: a flit per cycle).")
+    parser.add_option("--int-link-width", action="store", type="int", default=0,
+                      help="width in bytes of the garnet2.0 links between routers (0: a flit per cycle).")
+    parser.add_option("--serdes-latency", action="store", type="int", default=1,
+                      help="latency of the serializer and of the deserializer of a garnet2.0 link narrower than a flit.")
     parser.add_option("--vcs-per-vnet", action="store", type="int", default=4,
                       help="number of virtual channels per virtual network inside garnet network.")
+    parser.add_option("--express-hops", action="store", type="int", default=0,
+                      help="hops spanned by the garnet2.0 express links of Mesh and Torus, which bypass the routers in between (0: none).")
     parser.add_option("--routing-algorithm", action="store", type="int", default=1,
-                      help="routing algorithm in network. 0: weight-based table, 1: XY (for 2D), 2: Random (for 2D)")
+                      help="routing algorithm in network. 0: weight-based table, 1: XY (for 2D), 2: Random (for 2D), 4: ECMP, 5: adaptive")
+    parser.add_option("--ecmp-seed", action="store", type="int", default=0,
+                      help="seed of the per-flow hash used by ECMP routing.")
+    parser.add_option("--sw-allocator", type="choice", default="separable",
+                      choices=['separable', 'islip'],
+                      help="garnet2.0 switch allocator: 'separable' (input-first round robin) | 'islip'.")
+    parser.add_option("--sw-alloc-iterations", type="int", default=1,
+                      help="iterations of the garnet2.0 iSLIP switch allocator.")
+    parser.add_option("--packet-chaining", action="store_true", default=False,
+                      help="garnet2.0 packets keep the switch connection granted to their head flit.")
+    parser.add_option("--network-multicast", action="store_true", default=False,
+                      help="garnet2.0 sends a message to all its destinations as one packet, forked in the routers.")
+    parser.add_option("--network-partitions", type="int", default=1,
+                      help="number of event queues (threads) the garnet2.0 routers and NIs are split across.")
+    parser.add_option("--routing-table-cache", type="string", default="",
+                      help="file in which the network routing tables are cached across runs with the same topology.")
+    parser.add_option("--network-trace", type="string", default="",
+                      help="garnet2.0 packet trace (see src/proto/netpacket.proto) replayed into the network interfaces.")
+    parser.add_option("--network-heatmap", type="string", default="",
+                      help="CSV file, in the output directory, of garnet2.0 per-link and per-router activity.")
+    parser.add_option("--network-heatmap-period", type="int", default=0,
+                      help="cycles between network heatmap snapshots, besides those at stats dumps.")
     parser.add_option("--network-fault-model", action="store_true", default=False,
                       help="enable network fault model: see src/mem/ruby/network/fault_model/")
 
@@ -89,6 +121,10 @@ def define_options(parser):
 
     parser.add_option("--recycle-latency", type="int", default=10,
                       help="Recycle latency for ruby controller input buffers")
+    parser.add_option("--message-buffer-queue", type="choice",
+                      default="heap", choices=["heap", "calendar"],
+                      help="queue of the messages waiting in ruby message "
+                           "buffers: binary heap or calendar of time buckets")
 
     protocol = buildEnv['PROTOCOL']
     exec "import %s" % protocol
@@ -155,6 +191,39 @@ def create_topology(controllers, options):
     topology = eval("Topo.%s(controllers)" % options.topology)
     return topology
 
+def partition_network(network, num_partitions):
+    """ Split a garnet2.0 network across event queues. The routers are
+        assigned in contiguous blocks of router ids; a controller and its
+        NI go with the router they attach to. A link runs in the event
+        queue of the object that sends on it, and its latency bounds the
+        simulation quantum.
+    """
+    num_routers = len(network.routers)
+    def partition(router):
+        return router.router_id * num_partitions / num_routers
+
+    for router in network.routers:
+        router.eventq_index = partition(router)
+
+    # The NIs are numbered like the controllers they serve, which is the
+    # order of the external links (this is checked in GarnetNetwork)
+    for (i, link) in enumerate(network.ext_links):
+        p = partition(link.int_node)
+        link.ext_node.eventq_index = p
+        network.netifs[i].eventq_index = p
+        for l in link.network_links + link.credit_links:
+            l.eventq_index = p
+
+    # network_links[0] carries flits from node_a to node_b, and
+    # credit_links[0] returns the credits for it from node_b
+    for link in network.int_links:
+        a = partition(link.node_a)
+        b = partition(link.node_b)
+        link.network_links[0].eventq_index = a
+        link.network_links[1].eventq_index = b
+        link.credit_links[0].eventq_index = b
+        link.credit_links[1].eventq_index = a
+
 def create_system(options, full_system, system, piobus = None, dma_ports = []):
 
     system.ruby = RubySystem()
@@ -165,7 +234,10 @@ def create_system(options, full_system, system, piobus = None, dma_ports = []):
         NetworkClass = GarnetNetwork
         IntLinkClass = GarnetIntLink
         ExtLinkClass = GarnetExtLink
-        RouterClass = GarnetRouter
+        if options.router_model == "deflection":
+            RouterClass = GarnetDeflectionRouter
+        else:
+            RouterClass = GarnetRouter
         InterfaceClass = GarnetNetworkInterface
 
     elif options.network == "garnet-fixed-pipeline":
@@ -194,6 +266,9 @@ def create_system(options, full_system, system, piobus = None, dma_ports = []):
             routers = [], ext_links = [], int_links = [], netifs = [])
     ruby.network = network
 
+    # All the message buffers the protocol creates use this queue
+    MessageBuffer.queue = options.message_buffer_queue
+
     protocol = buildEnv['PROTOCOL']
     exec "import %s" % protocol
     try:
@@ -228,6 +303,24 @@ def create_system(options, full_system, system, piobus = None, dma_ports = []):
         network.vcs_per_vnet = options.vcs_per_vnet
         network.ni_flit_size = options.channel_width_bits / 8
         network.routing_algorithm = options.routing_algorithm
+        network.ecmp_seed = options.ecmp_seed
+        network.serdes_latency = options.serdes_latency
+        # Topologies may set the widths of their links themselves
+        if options.ext_link_width > 0:
+            for link in network.ext_links:
+                link.width = options.ext_link_width
+        if options.int_link_width > 0:
+            for link in network.int_links:
+                link.width = options.int_link_width
+        network.sw_allocator = options.sw_allocator
+        network.sw_alloc_iterations = options.sw_alloc_iterations
+        network.packet_chaining = options.packet_chaining
+        network.multicast = options.network_multicast
+        network.trace_file = options.network_trace
+        network.heatmap_file = options.network_heatmap
+        network.heatmap_period = options.network_heatmap_period
+
+    network.routing_table_cache = options.routing_table_cache
 
     if options.network == "simple":
         assert(NetworkClass == SimpleNetwork)
@@ -238,6 +331,10 @@ def create_system(options, full_system, system, piobus = None, dma_ports = []):
         netifs = [InterfaceClass(id=i) for (i,n) in enumerate(network.ext_links)]
         network.netifs = netifs
 
+    if options.network_partitions > 1:
+        assert(options.network == "garnet2.0")
+        partition_network(network, options.network_partitions)
+
     if options.network_fault_model:
         assert(options.network == "garnet-fixed-pipeline")
         network.enable_fault_model = True
@@ -106,6 +106,8 @@ class Torus(SimpleTopology):
                 int_links.append(IntLink(link_id=link_count,
                                         node_a=routers[east_id],
                                         node_b=routers[west_id],
+                                        node_a_port=1, # west port
+                                        node_b_port=3, # east port
                                         latency=1,
                                         weight=1))
                 link_count += 1
@@ -121,8 +123,45 @@ class Torus(SimpleTopology):
                 int_links.append(IntLink(link_id=link_count,
                                         node_a=routers[north_id],
                                         node_b=routers[south_id],
+                                        node_a_port=4, # north port
+                                        node_b_port=2, # south port
                                         latency=1,
                                         weight=2))
                 link_count += 1
 
+        # Express links, every express_hops routers along each row and
+        # column, without wrapping around. They bypass the routers they
+        # span, whose pipelines the flits skip, and weigh as much as the
+        # links they parallel.
+        hops = options.express_hops
+        if hops > 1:
+            assert(options.network == "garnet2.0")
+            for row in xrange(num_rows):
+                for col in xrange(0, num_columns - hops, hops):
+                    west_id = col + (row * num_columns)
+                    east_id = (col + hops) + (row * num_columns)
+                    int_links.append(IntLink(link_id=link_count,
+                                            node_a=routers[east_id],
+                                            node_b=routers[west_id],
+                                            node_a_port=1, # west port
+                                            node_b_port=3, # east port
+                                            latency=hops,
+                                            weight=hops,
+                                            bypass_hops=hops - 1))
+                    link_count += 1
+
+            for col in xrange(num_columns):
+                for row in xrange(0, num_rows - hops, hops):
+                    north_id = col + (row * num_columns)
+                    south_id = col + ((row + hops) * num_columns)
+                    int_links.append(IntLink(link_id=link_count,
+                                            node_a=routers[north_id],
+                                            node_b=routers[south_id],
+                                            node_a_port=4, # north port
+                                            node_b_port=2, # south port
+                                            latency=hops,
+                                            weight=2 * hops,
+                                            bypass_hops=hops - 1))
+                    link_count += 1
+
         network.int_links = int_links
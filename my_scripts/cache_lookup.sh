@@ -0,0 +1,34 @@
+#!/bin/csh
+#
+# Host time of the Ruby cache lookups under MESI_Two_Level with 16 and 32
+# cores. Each gem5 binary (e.g. built before and after a change to
+# CacheMemory) runs the Ruby random tester, and "<cores> <L1 accesses>
+# <L2 accesses> <host seconds> <accesses per host second>" is appended to
+# cache_lookup_<binary>.txt.
+#
+# usage: ./my_scripts/cache_lookup.sh <gem5 binary> [<gem5 binary> ...]
+#   e.g. ./my_scripts/cache_lookup.sh build/X86_MESI_Two_Level/gem5.opt
+
+if ($#argv < 1) then
+  echo "usage: $0 <gem5 binary> [<gem5 binary> ...]"
+  exit 1
+endif
+
+foreach gem5 ($argv)
+  set outfile = cache_lookup_`echo $gem5 | tr / _`.txt
+  echo -n > $outfile
+
+  foreach cores (16 32)
+    $gem5 -d m5out_cache_lookup configs/example/ruby_random_test.py \
+      --num-cpus=$cores --num-dirs=4 --num-l2caches=$cores \
+      --l1d_size=32kB --l1d_assoc=8 --l2_size=256kB --l2_assoc=16 \
+      --maxloads=50000 > /dev/null
+
+    set stats = m5out_cache_lookup/stats.txt
+    set l1 = `grep "L1Dcache.demand_accesses" $stats | awk '{s += $2} END {print s}'`
+    set l2 = `grep "L2cache.demand_accesses" $stats | awk '{s += $2} END {print s}'`
+    set host = `grep "^host_seconds" $stats | awk '{print $2}'`
+    set rate = `echo "($l1 + $l2) / $host" | bc -l`
+    echo "$cores $l1 $l2 $host $rate" >> $outfile
+  end
+end
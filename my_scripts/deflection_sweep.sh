@@ -0,0 +1,42 @@
+#!/bin/csh
+#
+# Saturation throughput of the bufferless deflection router against the
+# VC router, on 4x4 Mesh and Torus topologies under uniform random,
+# mesh tornado and mesh bit-complement traffic. Each run is an in-process
+# injection rate sweep of ruby_network_test.py; its table, with the
+# accepted rate, latencies and deflection rate at every step, is copied
+# to <topology>_<pattern>_<router model>_sweep.txt. The saturation
+# throughput is the highest accepted rate of the table.
+#
+# usage: ./my_scripts/deflection_sweep.sh [gem5 binary]
+
+set gem5 = ./build/ALPHA_Network_test/gem5.opt
+if ($#argv >= 1) then
+  set gem5 = $1
+endif
+
+foreach topology (Mesh Torus)
+  foreach synthetic (0 13 14)
+    if ($synthetic == 0) then
+      set pattern = uniform
+    else if ($synthetic == 13) then
+      set pattern = tornado
+    else
+      set pattern = bitcomp
+    endif
+
+    foreach model (vc deflection)
+      $gem5 -d m5out_deflection configs/example/ruby_network_test.py \
+        --network=garnet2.0 --num-cpus=16 --num-dirs=16 \
+        --topology=$topology --num-rows=4 --synthetic=$synthetic \
+        --vcs-per-vnet=4 --router-model=$model \
+        --sweep --sweep-step=0.02 > /dev/null
+
+      set outfile = ${topology}_${pattern}_${model}_sweep.txt
+      cp m5out_deflection/injection_sweep.txt $outfile
+
+      set saturation = `grep -v "^#" $outfile | sort -g -k2 | tail -1 | awk '{print $2}'`
+      echo "$topology $pattern $model: saturation throughput $saturation packets/node/cycle"
+    end
+  end
+end
@@ -0,0 +1,43 @@
+#!/bin/csh
+#
+# Low-load packet latency of 8x8 and 16x16 Mesh and Torus topologies
+# without express links and with express links spanning 2 and 4 hops,
+# under uniform random traffic. Mesh uses XY routing and Torus table
+# routing. Appends "<express hops> <average_packet_latency>
+# <bypass_rate>" to express_<topology>_<routers>.txt.
+#
+# usage: ./my_scripts/express_latency.sh [gem5 binary]
+
+set gem5 = ./build/ALPHA_Network_test/gem5.opt
+if ($#argv >= 1) then
+  set gem5 = $1
+endif
+
+foreach topology (Mesh Torus)
+  if ($topology == Mesh) then
+    set routing = 1
+  else
+    set routing = 0
+  endif
+
+  foreach rows (8 16)
+    @ routers = $rows * $rows
+    set outfile = express_${topology}_${routers}.txt
+    echo -n > $outfile
+
+    foreach hops (0 2 4)
+      $gem5 -d m5out_express configs/example/ruby_network_test.py \
+        --network=garnet2.0 --num-cpus=$routers --num-dirs=$routers \
+        --topology=$topology --num-rows=$rows --sim-cycles=20000 \
+        --injectionrate=0.02 --synthetic=0 --vcs-per-vnet=4 \
+        --routing-algorithm=$routing --express-hops=$hops > /dev/null
+
+      set latency = `grep "average_packet_latency" m5out_express/stats.txt | awk '{print $2}'`
+      set bypass = `grep "bypass_rate" m5out_express/stats.txt | awk '{print $2}'`
+      if ("$bypass" == "") then
+        set bypass = 0
+      endif
+      echo "$hops $latency $bypass" >> $outfile
+    end
+  end
+end
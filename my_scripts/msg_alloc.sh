@@ -0,0 +1,36 @@
+#!/bin/csh
+#
+# Heap allocations and locked (atomic) instructions of the Ruby message
+# handling, for a gem5 binary built before and after a change to it. Each
+# binary runs the Ruby random tester and the se.py Ruby config. The heap
+# allocations are counted by valgrind, and the locked instructions by
+# perf, which needs an Intel host. Results go to msg_alloc_<binary>.txt
+# as "<config> <heap allocations> <locked instructions> <host seconds>".
+#
+# usage: ./my_scripts/msg_alloc.sh <gem5 binary> [<gem5 binary> ...]
+#   e.g. ./my_scripts/msg_alloc.sh build/base/gem5.opt \
+#            build/X86_MOESI_hammer/gem5.opt
+
+if ($#argv < 1) then
+  echo "usage: $0 <gem5 binary> [<gem5 binary> ...]"
+  exit 1
+endif
+
+foreach gem5 ($argv)
+  set outfile = msg_alloc_`echo $gem5 | tr / _`.txt
+  echo -n > $outfile
+
+  foreach config (random se)
+    if ($config == random) then
+      set args = "configs/example/ruby_random_test.py --num-cpus=8 --maxloads=20000"
+    else
+      set args = "configs/example/se.py --ruby --num-cpus=1 -c tests/test-progs/hello/bin/x86/linux/hello"
+    endif
+
+    set allocs = `valgrind --tool=memcheck --leak-check=no $gem5 -d m5out_msg_alloc $args |& grep "total heap usage" | awk '{print $5}' | tr -d ,`
+
+    set locked = `perf stat -x, -e mem_inst_retired.lock_loads $gem5 -d m5out_msg_alloc $args |& grep lock_loads | cut -d, -f1`
+    set host = `grep "^host_seconds" m5out_msg_alloc/stats.txt | awk '{print $2}'`
+    echo "$config $allocs $locked $host" >> $outfile
+  end
+end
@@ -0,0 +1,42 @@
+#!/bin/csh
+#
+# Ruby throughput with the heap and the calendar message buffer queues
+# (--message-buffer-queue). Each gem5 binary runs the Ruby random tester
+# and, with a Network_test binary, ruby_network_test.py at a high
+# injection rate. "<config> <queue> <host seconds> <sim ticks per host
+# second>" is appended to msg_buffer_queue_<binary>.txt.
+#
+# usage: ./my_scripts/msg_buffer_queue.sh <gem5 binary> [<gem5 binary> ...]
+#   e.g. ./my_scripts/msg_buffer_queue.sh build/X86_MESI_Two_Level/gem5.opt \
+#            build/ALPHA_Network_test/gem5.opt
+
+if ($#argv < 1) then
+  echo "usage: $0 <gem5 binary> [<gem5 binary> ...]"
+  exit 1
+endif
+
+foreach gem5 ($argv)
+  set outfile = msg_buffer_queue_`echo $gem5 | tr / _`.txt
+  echo -n > $outfile
+
+  foreach queue (heap calendar)
+    if ("$gem5" =~ *Network_test*) then
+      set config = network_test
+      $gem5 -d m5out_msg_buffer_queue configs/example/ruby_network_test.py \
+        --network=garnet2.0 --num-cpus=64 --num-dirs=64 \
+        --topology=Mesh_XY --num-rows=8 --sim-cycles=100000 \
+        --synthetic=0 --injectionrate=0.3 \
+        --message-buffer-queue=$queue > /dev/null
+    else
+      set config = random_test
+      $gem5 -d m5out_msg_buffer_queue configs/example/ruby_random_test.py \
+        --num-cpus=16 --num-dirs=4 --maxloads=50000 \
+        --message-buffer-queue=$queue > /dev/null
+    endif
+
+    set stats = m5out_msg_buffer_queue/stats.txt
+    set host = `grep "^host_seconds" $stats | awk '{print $2}'`
+    set rate = `grep "^host_tick_rate" $stats | awk '{print $2}'`
+    echo "$config $queue $host $rate" >> $outfile
+  end
+end
@@ -0,0 +1,38 @@
+#!/bin/csh
+#
+# Tree-based multicast in garnet2.0 under the broadcast-heavy protocols.
+# MOESI_hammer and MOESI_CMP_token are run with the Ruby random tester on
+# a 4x4 Mesh, with one unicast packet per destination and with multicast
+# packets. Each run prints the flits injected, the flits the NIs saved and
+# the routers replicated, and the average packet latency.
+#
+# usage: ./my_scripts/multicast_compare.sh [loads per cpu]
+
+set maxloads = 10000
+if ($#argv >= 1) then
+  set maxloads = $1
+endif
+
+foreach protocol (MOESI_hammer MOESI_CMP_token)
+  set gem5 = ./build/ALPHA_${protocol}/gem5.opt
+
+  foreach mode (unicast multicast)
+    set mode_opts = ""
+    if ($mode == multicast) then
+      set mode_opts = "--network-multicast"
+    endif
+
+    set outdir = m5out_multicast_${protocol}_${mode}
+    $gem5 -d $outdir configs/example/ruby_random_test.py \
+      --network=garnet2.0 --num-cpus=16 --num-dirs=16 \
+      --topology=Mesh --num-rows=4 --routing-algorithm=0 \
+      --maxloads=$maxloads $mode_opts > /dev/null
+
+    set stats = $outdir/stats.txt
+    set flits = `grep "flits_injected::total" $stats | awk '{print $2}'`
+    set latency = `grep "average_packet_latency" $stats | awk '{print $2}'`
+    set saved = `grep "multicast_flits_saved" $stats | awk '{print $2}'`
+    set replicated = `grep "multicast_flits_replicated" $stats | awk '{print $2}'`
+    echo "$protocol $mode: flits injected $flits saved $saved replicated $replicated, average packet latency $latency"
+  end
+end
@@ -0,0 +1,35 @@
+#!/bin/csh
+#
+# Scaling of a garnet2.0 network partitioned across 1, 2, 4 and 8 event
+# queues (threads), running ruby_network_test.py with uniform random
+# traffic on the k=4 GoogleFatTree_m topology. Appends
+# "<threads> <host seconds> <speedup over 1 thread>" to
+# parallel_scaling_<injection rate>.txt.
+#
+# usage: ./my_scripts/parallel_scaling.sh [gem5 binary]
+
+set gem5 = ./build/ALPHA_Network_test/gem5.opt
+if ($#argv >= 1) then
+  set gem5 = $1
+endif
+
+foreach injection (0.02 0.1 0.3)
+  set outfile = parallel_scaling_${injection}.txt
+  echo -n > $outfile
+
+  set serial = 0
+  foreach threads (1 2 4 8)
+    $gem5 -d m5out_scaling configs/example/ruby_network_test.py \
+      --network=garnet2.0 --num-cpus=16 --num-dirs=16 \
+      --topology=GoogleFatTree_m --num-rows=0 --sim-cycles=100000 \
+      --injectionrate=$injection --synthetic=0 \
+      --vcs-per-vnet=4 --network-partitions=$threads > /dev/null
+
+    set host = `grep "^host_seconds" m5out_scaling/stats.txt | awk '{print $2}'`
+    if ($threads == 1) then
+      set serial = $host
+    endif
+    set speedup = `echo "$serial / $host" | bc -l`
+    echo "$threads $host $speedup" >> $outfile
+  end
+end
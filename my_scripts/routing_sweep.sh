@@ -0,0 +1,43 @@
+#!/bin/csh
+#
+# Injection-rate sweep comparing table, ECMP and adaptive routing on the
+# k=4 GoogleFatTree_m topology under tornado and bit-complement traffic.
+# Each run appends "<injection rate> <average_packet_latency>" to
+# Google_lat_<pattern>_r<routing algorithm>.txt; the saturation point is
+# where the latency curve turns up.
+#
+# usage: ./my_scripts/routing_sweep.sh [gem5 binary]
+
+set gem5 = ./build/ALPHA_Network_test/gem5.opt
+if ($#argv >= 1) then
+  set gem5 = $1
+endif
+
+foreach routing (0 4 5)
+  foreach synthetic (1 2)
+    if ($synthetic == 1) then
+      set pattern = tornado
+    else
+      set pattern = bitcomp
+    endif
+
+    set outfile = Google_lat_${pattern}_r${routing}.txt
+    echo -n > $outfile
+
+    set injectionrate = 2
+    while ($injectionrate <= 150)
+      set injection = `echo "$injectionrate * (1/100)" | bc -l`
+
+      $gem5 -d m5out_sweep configs/example/ruby_network_test.py \
+        --network=garnet2.0 --num-cpus=16 --num-dirs=16 \
+        --topology=GoogleFatTree_m --num-rows=0 --sim-cycles=10000 \
+        --injectionrate=$injection --synthetic=$synthetic \
+        --vcs-per-vnet=4 --routing-algorithm=$routing > /dev/null
+
+      set latency = `grep "average_packet_latency" m5out_sweep/stats.txt | awk '{print $2}'`
+      echo "$injection $latency" >> $outfile
+
+      @ injectionrate = $injectionrate + 5
+    end
+  end
+end
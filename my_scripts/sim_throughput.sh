@@ -0,0 +1,45 @@
+#!/bin/csh
+#
+# Simulator-throughput benchmark for ruby_network_test.py on the k=4
+# GoogleFatTree_m topology. For each injection rate it appends
+# "<injection rate> <host seconds per simulated kilocycle>" to
+# sim_throughput_<pattern>.txt. The low injection rates are where the
+# time spent waking up idle routers, links and NIs stands out.
+#
+# usage: ./my_scripts/sim_throughput.sh [gem5 binary] [extra options]
+#   e.g. ./my_scripts/sim_throughput.sh build/ALPHA_Network_test/gem5.opt \
+#            --num-pipe-stages=1
+
+set gem5 = ./build/ALPHA_Network_test/gem5.opt
+set extra = ""
+if ($#argv >= 1) then
+  set gem5 = $1
+endif
+if ($#argv >= 2) then
+  set extra = "$argv[2-]"
+endif
+
+set cycles = 100000
+
+foreach synthetic (0 1)
+  if ($synthetic == 0) then
+    set pattern = uniform
+  else
+    set pattern = tornado
+  endif
+
+  set outfile = sim_throughput_${pattern}.txt
+  echo -n > $outfile
+
+  foreach injection (0.001 0.005 0.01 0.02 0.05 0.1 0.2 0.3)
+    $gem5 -d m5out_simtput configs/example/ruby_network_test.py \
+      --network=garnet2.0 --num-cpus=16 --num-dirs=16 \
+      --topology=GoogleFatTree_m --num-rows=0 --sim-cycles=$cycles \
+      --injectionrate=$injection --synthetic=$synthetic \
+      --vcs-per-vnet=4 $extra > /dev/null
+
+    set host = `grep "^host_seconds" m5out_simtput/stats.txt | awk '{print $2}'`
+    set per_kcycle = `echo "$host * 1000 / $cycles" | bc -l`
+    echo "$injection $per_kcycle" >> $outfile
+  end
+end
@@ -0,0 +1,31 @@
+#!/bin/csh
+#
+# Startup-time benchmark: host seconds to build and start a garnet2.0
+# network of increasing size. Each run simulates a single cycle of
+# ruby_network_test.py on a Mesh of rows x rows routers, so the time
+# is dominated by topology setup and routing table construction.
+# Appends "<routers> <host seconds>" to startup_time.txt.
+#
+# usage: ./my_scripts/startup_time.sh [gem5 binary]
+
+set gem5 = ./build/ALPHA_Network_test/gem5.opt
+if ($#argv >= 1) then
+  set gem5 = $1
+endif
+
+set outfile = startup_time.txt
+echo -n > $outfile
+
+foreach rows (4 8 12 16 20 24 32)
+  @ routers = $rows * $rows
+
+  set start = `date +%s.%N`
+  $gem5 -d m5out_startup configs/example/ruby_network_test.py \
+    --network=garnet2.0 --num-cpus=$routers --num-dirs=$routers \
+    --topology=Mesh --num-rows=$rows --sim-cycles=1 \
+    --injectionrate=0 > /dev/null
+  set end = `date +%s.%N`
+
+  set seconds = `echo "$end - $start" | bc -l`
+  echo "$routers $seconds" >> $outfile
+end
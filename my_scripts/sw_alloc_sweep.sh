@@ -0,0 +1,43 @@
+#!/bin/csh
+#
+# Saturation throughput of the garnet2.0 switch allocators on an 8x8
+# Mesh under uniform random traffic: separable and iSLIP (1 and 2
+# iterations), each without and with packet chaining. Each run is an
+# in-process injection rate sweep of ruby_network_test.py; its table is
+# copied to sw_alloc_<allocator>_<chaining>.txt. The saturation
+# throughput is the highest accepted rate of the table.
+#
+# usage: ./my_scripts/sw_alloc_sweep.sh [gem5 binary]
+
+set gem5 = ./build/ALPHA_Network_test/gem5.opt
+if ($#argv >= 1) then
+  set gem5 = $1
+endif
+
+foreach allocator (separable islip1 islip2)
+  if ($allocator == separable) then
+    set alloc_opts = "--sw-allocator=separable"
+  else if ($allocator == islip1) then
+    set alloc_opts = "--sw-allocator=islip --sw-alloc-iterations=1"
+  else
+    set alloc_opts = "--sw-allocator=islip --sw-alloc-iterations=2"
+  endif
+
+  foreach chaining (nochain chain)
+    set chain_opts = ""
+    if ($chaining == chain) then
+      set chain_opts = "--packet-chaining"
+    endif
+
+    $gem5 -d m5out_sw_alloc configs/example/ruby_network_test.py \
+      --network=garnet2.0 --num-cpus=64 --num-dirs=64 \
+      --topology=Mesh --num-rows=8 --synthetic=0 --vcs-per-vnet=4 \
+      $alloc_opts $chain_opts --sweep --sweep-step=0.02 > /dev/null
+
+    set outfile = sw_alloc_${allocator}_${chaining}.txt
+    cp m5out_sw_alloc/injection_sweep.txt $outfile
+
+    set saturation = `grep -v "^#" $outfile | sort -g -k2 | tail -1 | awk '{print $2}'`
+    echo "$allocator $chaining: saturation throughput $saturation packets/node/cycle"
+  end
+end
@@ -0,0 +1,40 @@
+#!/bin/csh
+#
+# Controller throughput with the SLICC transition switch and with the
+# dense transition tables (SLICC_TRANSITION_TABLE=True). Builds X86
+# gem5.opt for MESI_Three_Level and MOESI_CMP_directory both ways, runs the
+# Ruby random tester on each and appends "<protocol> <dispatch> <host
+# seconds> <sim ticks per host second>" to transition_table.txt.
+#
+# usage: ./my_scripts/transition_table.sh [scons jobs]
+
+set jobs = 8
+if ($#argv >= 1) then
+  set jobs = $1
+endif
+
+set outfile = transition_table.txt
+echo -n > $outfile
+
+foreach protocol (MESI_Three_Level MOESI_CMP_directory)
+  foreach dispatch (switch table)
+    if ($dispatch == table) then
+      set table = True
+    else
+      set table = False
+    endif
+
+    set gem5 = build/X86_${protocol}_${dispatch}/gem5.opt
+    scons -j $jobs $gem5 --default=X86 PROTOCOL=$protocol \
+      SLICC_TRANSITION_TABLE=$table > /dev/null || exit 1
+
+    $gem5 -d m5out_transition_table configs/example/ruby_random_test.py \
+      --num-cpus=16 --num-dirs=4 --num-l2caches=16 \
+      --maxloads=100000 > /dev/null
+
+    set stats = m5out_transition_table/stats.txt
+    set host = `grep "^host_seconds" $stats | awk '{print $2}'`
+    set rate = `grep "^host_tick_rate" $stats | awk '{print $2}'`
+    echo "$protocol $dispatch $host $rate" >> $outfile
+  end
+end
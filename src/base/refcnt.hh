@@ -31,6 +31,8 @@
 #ifndef __BASE_REFCNT_HH__
 #define __BASE_REFCNT_HH__
 
+#include <type_traits>
+
 /**
  * @file base/refcnt.hh
  *
@@ -163,6 +165,16 @@ class RefCountingPtr
     /// one.  Adds a reference.
     RefCountingPtr(const RefCountingPtr &r) { copy(r.data); }
 
+    /// Create a new reference counting pointer by copying one to an
+    /// object of a derived class.  Adds a reference.
+    template <class U, class = typename std::enable_if<
+                           std::is_convertible<U *, T *>::value>::type>
+    RefCountingPtr(const RefCountingPtr<U> &r) { copy(r.get()); }
+
+    /// Create a new reference counting pointer by taking over the
+    /// reference of another one, which is left empty.
+    RefCountingPtr(RefCountingPtr &&r) : data(r.data) { r.data = 0; }
+
     /// Destroy the pointer and any reference it may hold.
     ~RefCountingPtr() { del(); }
 
@@ -186,6 +198,19 @@ class RefCountingPtr
     const RefCountingPtr &operator=(const RefCountingPtr &r)
     { return operator=(r.data); }
 
+    /// Take over the reference of another RefCountingPtr, which is
+    /// left empty
+    const RefCountingPtr &
+    operator=(RefCountingPtr &&r)
+    {
+        if (this != &r) {
+            del();
+            data = r.data;
+            r.data = 0;
+        }
+        return *this;
+    }
+
     /// Check if the pointer is empty
     bool operator!() const { return data == 0; }
 
@@ -30,6 +30,13 @@ from MemObject import MemObject
 from m5.params import *
 from m5.proxy import *
 
+# bernoulli: a tester wakes up every cycle and sends with probability
+# inj_rate. geometric: the same process, but the tester only wakes up
+# for the cycles in which it sends. exponential: Poisson arrivals at
+# inj_rate per cycle, possibly several in a cycle.
+class NetworkTestArrival(Enum): vals = ['bernoulli', 'geometric',
+                                        'exponential']
+
 class NetworkTest(MemObject):
     type = 'NetworkTest'
     cxx_header = "cpu/testers/networktest/networktest.hh"
@@ -42,7 +49,25 @@ class NetworkTest(MemObject):
     single_sender = Param.Int(-1, "Send only from this node. By default every node sends")
     single_dest   = Param.Int(-1, "Send only to this dest. Default depends on traffic_type")
     traffic_type = Param.Counter(0, "Traffic type: uniform random, tornado, bit complement")
+    hotspot_fraction = Param.Float(0.5, "Fraction of the hotspot traffic "
+                                   "sent to target_dest")
+    target_dest = Param.Int(0, "Destination of the hotspot and incast traffic")
+    stride = Param.Int(1, "Distance between source and destination of the "
+                       "stride traffic")
+    pattern_seed = Param.UInt32(1, "Seed of the random permutation traffic")
     inj_rate = Param.Float(0.1, "Packet injection rate")
+    arrival = Param.NetworkTestArrival('bernoulli', "Packet arrival process")
+    burst_on_cycles = Param.Float(0, "Mean length of the on periods of "
+        "on/off bursty traffic, in cycles (0: not bursty)")
+    burst_off_cycles = Param.Float(0, "Mean length of the off periods of "
+        "on/off bursty traffic, in cycles")
     precision = Param.Int(3, "Number of digits of precision after decimal point")
     test = MasterPort("Port to the memory system to test")
     system = Param.System(Parent.any, "System we belong to")
+
+    @classmethod
+    def export_methods(cls, code):
+        code('''
+      double getInjRate() const;
+      void setInjRate(double rate);
+''')
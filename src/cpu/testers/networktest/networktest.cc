@@ -79,6 +79,7 @@ NetworkTest::NetworkTest(const Params *p)
       cachePort("network-test", this),
       retryPkt(NULL),
       size(p->memory_size),
+      id(TESTER_NETWORK++),
       blockSizeBits(p->block_offset),
       numMemories(p->num_memories),
       simCycles(p->sim_cycles),
@@ -87,17 +88,45 @@ NetworkTest::NetworkTest(const Params *p)
       singleSender(p->single_sender),
       singleDest(p->single_dest),
       trafficType(p->traffic_type),
+      rng(id),
       injRate(p->inj_rate),
       precision(p->precision),
+      arrival(p->arrival),
+      burstOnCycles(p->burst_on_cycles),
+      burstOffCycles(p->burst_off_cycles),
+      burstOn(true),
+      burstStart(0),
+      burstEnd(0),
+      nextArrivalCycle(-1),
+      lastTickCycle(0),
       masterId(p->system->getMasterId(name()))
 {
     // set up counters
     noResponseCycles = 0;
     schedule(tickEvent, 0);
 
-    id = TESTER_NETWORK++;
+    if ((burstOnCycles > 0) != (burstOffCycles > 0))
+        fatal("%s: bursty traffic needs both on and off periods\n", name());
+    if (bursty()) {
+        if (burstOnCycles < 1 || burstOffCycles < 1)
+            fatal("%s: burst periods must last a cycle or more\n", name());
+
+        // Start in a period drawn from the stationary distribution
+        burstOn = rng.random<double>() <
+            burstOnCycles / (burstOnCycles + burstOffCycles);
+        burstEnd = sampleGeometric(
+            1 / (burstOn ? burstOnCycles : burstOffCycles));
+    }
+    if (onRate() > 1 && arrival != Enums::exponential) {
+        warn("%s: rate of %f packets per cycle capped to 1\n", name(),
+             onRate());
+    }
+
     DPRINTF(NetworkTest,"Config Created: Name = %s , and id = %d\n",
             name(), id);
+
+    if (singleDest < 0)
+        destTable = buildDestinationTable(trafficType, id, numMemories, p);
 }
 
 BaseMasterPort &
@@ -135,35 +164,48 @@ NetworkTest::completeRequest(PacketPtr pkt)
 void
 NetworkTest::tick()
 {
-    if (++noResponseCycles >= 500000) {
+    Cycles now = curCycle();
+    noResponseCycles += now - lastTickCycle;
+    lastTickCycle = now;
+    if (noResponseCycles >= 500000) {
         cerr << name() << ": deadlocked at cycle " << curTick() << endl;
         fatal("");
     }
 
-    // make new request based on injection rate
-    // (injection rate's range depends on precision)
-    // - generate a random number between 0 and 10^precision
-    // - send pkt if this number is < injRate*(10^precision)
-    bool sendAllowedThisCycle;
-    double injRange = pow((double) 10, (double) precision);
-    unsigned trySending = random_mt.random<unsigned>(0, (int) injRange);
-    if (trySending < injRate*injRange)
-        sendAllowedThisCycle = true;
-    else
-        sendAllowedThisCycle = false;
-
-    // always generatePkt unless fixedPkts or singleSender is enabled
-    if (sendAllowedThisCycle) {
-        bool senderEnable = true;
-
-        if (numPacketsMax >= 0 && numPacketsSent >= numPacketsMax)
-            senderEnable = false;
+    if (arrival == Enums::bernoulli) {
+        double rate = injRate;
+        if (bursty()) {
+            while (now >= burstEnd)
+                nextBurstPeriod();
+            rate = burstOn ? onRate() : 0;
+        }
 
-        if (singleSender >= 0 && id != singleSender)
-            senderEnable = false;
+        // make new request based on injection rate
+        // (injection rate's range depends on precision)
+        // - generate a random number between 0 and 10^precision
+        // - send pkt if this number is < injRate*(10^precision)
+        bool sendAllowedThisCycle;
+        double injRange = pow((double) 10, (double) precision);
+        unsigned trySending = rng.random<unsigned>(0, (int) injRange);
+        if (trySending < rate*injRange)
+            sendAllowedThisCycle = true;
+        else
+            sendAllowedThisCycle = false;
 
-        if (senderEnable)
+        // always generatePkt unless fixedPkts or singleSender is enabled
+        if (sendAllowedThisCycle && senderEnabled())
             generatePkt();
+    } else {
+        if (nextArrivalCycle < 0) {
+            // The earliest arrival is in this cycle
+            nextArrivalCycle = sampleNextArrival(
+                arrival == Enums::geometric ? now - 1.0 : now);
+        }
+        while (nextArrivalCycle <= now) {
+            if (senderEnabled())
+                generatePkt();
+            nextArrivalCycle = sampleNextArrival(nextArrivalCycle);
+        }
     }
 
     // Schedule wakeup
@@ -171,71 +213,123 @@ NetworkTest::tick()
         exitSimLoop("Network Tester completed simCycles");
     else {
         if (!tickEvent.scheduled())
-            schedule(tickEvent, clockEdge(Cycles(1)));
+            scheduleTick();
+    }
+}
+
+void
+NetworkTest::scheduleTick()
+{
+    if (arrival == Enums::bernoulli) {
+        schedule(tickEvent, clockEdge(Cycles(1)));
+        return;
+    }
+
+    // Wake up for the next packet, or to end the simulation
+    Tick when = simCycles;
+    double delta = ceil(nextArrivalCycle) - curCycle();
+    if (delta < ticksToCycles(simCycles - curTick()))
+        when = clockEdge(Cycles(max(delta, 1.0)));
+    schedule(tickEvent, max(when, clockEdge(Cycles(1))));
+}
+
+void
+NetworkTest::setInjRate(double rate)
+{
+    injRate = rate;
+
+    // Resample the next packet at the new rate
+    if (arrival != Enums::bernoulli && tickEvent.scheduled()) {
+        nextArrivalCycle = -1;
+        reschedule(tickEvent, clockEdge(Cycles(1)));
+    }
+}
+
+bool
+NetworkTest::senderEnabled() const
+{
+    if (numPacketsMax >= 0 && numPacketsSent >= numPacketsMax)
+        return false;
+    if (singleSender >= 0 && id != singleSender)
+        return false;
+    return true;
+}
+
+// Packets per cycle in the on periods
+double
+NetworkTest::onRate() const
+{
+    if (!bursty())
+        return injRate;
+    return injRate * (burstOnCycles + burstOffCycles) / burstOnCycles;
+}
+
+// Number of cycles until the first success of trials of probability p
+Cycles
+NetworkTest::sampleGeometric(double p)
+{
+    if (p >= 1)
+        return Cycles(1);
+    double u = 1 - rng.random<double>();
+    return Cycles(1 + (uint64_t) floor(log(u) / log(1 - p)));
+}
+
+void
+NetworkTest::nextBurstPeriod()
+{
+    burstOn = !burstOn;
+    burstStart = burstEnd;
+    burstEnd = burstStart +
+        sampleGeometric(1 / (burstOn ? burstOnCycles : burstOffCycles));
+}
+
+/**
+ * Cycle of the first packet after cycle t. Geometric arrivals are on
+ * whole cycles, from t + 1 on; exponential ones can come at any time
+ * after t. Both are memoryless, so an arrival which would fall past the
+ * end of an on period is simply drawn again from the start of the next.
+ */
+double
+NetworkTest::sampleNextArrival(double t)
+{
+    double rate = onRate();
+    if (rate <= 0 || !senderEnabled())
+        return INFINITY;
+
+    bool geometric = arrival == Enums::geometric;
+    double first = geometric ? 1 : 0;
+
+    while (true) {
+        if (bursty()) {
+            while (!burstOn || t + first >= burstEnd) {
+                nextBurstPeriod();
+                if (burstOn)
+                    t = max(t, burstStart - first);
+            }
+        }
+
+        double next;
+        if (geometric) {
+            next = t + sampleGeometric(rate);
+        } else {
+            next = t - log(1 - rng.random<double>()) / rate;
+        }
+
+        if (!bursty() || next < burstEnd)
+            return next;
+        t = burstEnd - first;
     }
 }
 
 void
 NetworkTest::generatePkt()
 {
-    int num_destinations = numMemories;
-    int radix = (int) sqrt(num_destinations);
-    unsigned destination = id;
-    int dest_x = -1;
-    int dest_y = -1;
-    int source = id;
-    int src_x = id%radix;
-    int src_y = id/radix;
+    unsigned destination;
 
     if (singleDest >= 0)
-    {
         destination = singleDest;
-    } else if (trafficType == UNIFORM_RANDOM_) {
-        destination = random_mt.random<unsigned>(0, num_destinations - 1);
-    } else if (trafficType == BIT_COMPLEMENT_) {
-        dest_x = radix - src_x - 1;
-        dest_y = radix - src_y - 1;
-        destination = dest_y*radix + dest_x;
-    } else if (trafficType == BIT_REVERSE_) {
-        unsigned int straight = source;
-        unsigned int reverse = source & 1; // LSB
-
-        int num_bits = (int) log2(num_destinations);
-
-        for (int i = 1; i < num_bits; i++)
-        {
-            reverse <<= 1;
-            straight >>= 1;
-            reverse |= (straight & 1); // LSB
-        }
-        destination = reverse;
-    } else if (trafficType == BIT_ROTATION_) {
-        if (source%2 == 0)
-            destination = source/2;
-        else // (source%2 == 1)
-            destination = ((source/2) + (num_destinations/2));
-    } else if (trafficType == NEIGHBOR_) {
-            dest_x = (src_x + 1) % radix;
-            dest_y = src_y;
-            destination = dest_y*radix + dest_x;
-    } else if (trafficType == SHUFFLE_) {
-        if (source < num_destinations/2)
-            destination = source*2;
-        else
-            destination = (source*2 - num_destinations + 1);
-    } else if (trafficType == TRANSPOSE_) {
-            dest_x = src_y;
-            dest_y = src_x;
-            destination = dest_y*radix + dest_x;
-    } else if (trafficType == TORNADO_) {
-        dest_x = (src_x + (int) ceil(radix/2) - 1) % radix;
-        dest_y = src_y;
-        destination = dest_y*radix + dest_x;
-    }
-    else {
-        cerr << "Unknown Traffic Type: " << trafficType << "!!" << endl;
-        fatal("");
-    }
+    else
+        destination = destTable.pick(rng);
 
     // The source of the packets is a cache.
     // The destination of the packets is a directory.
@@ -273,7 +367,7 @@ NetworkTest::generatePkt()
     Request *req = nullptr;
     Request::Flags flags;
 
-    unsigned randomReqType = random_mt.random(0, 2);
+    unsigned randomReqType = rng.random(0, 2);
 
     // TK: Added to inject only in vnet 0 for ICN course Lab 1
    // randomReqType = 0; //commented out for project ICN
@@ -34,6 +34,8 @@
 #include <set>
 
 #include "base/statistics.hh"
+#include "cpu/testers/networktest/trafficpattern.hh"
+#include "enums/NetworkTestArrival.hh"
 #include "mem/mem_object.hh"
 #include "mem/port.hh"
 #include "params/NetworkTest.hh"
@@ -42,16 +44,6 @@
 #include "sim/sim_object.hh"
 #include "sim/stats.hh"
 
-enum TrafficType {UNIFORM_RANDOM_ = 0,
-                  TORNADO_ = 1,
-                  BIT_COMPLEMENT_ = 2,
-                  BIT_REVERSE_ = 3,
-                  BIT_ROTATION_ = 4,
-                  NEIGHBOR_ = 5,
-                  SHUFFLE_ = 6,
-                  TRANSPOSE_ = 7,
-                  NUM_TRAFFIC_PATTERNS_};
-
 class Packet;
 class NetworkTest : public MemObject
 {
@@ -73,6 +65,13 @@ class NetworkTest : public MemObject
      */
     void printAddr(Addr a);
 
+    /**
+     * Injection rate, changed from Python between the steps of an
+     * injection rate sweep.
+     */
+    double getInjRate() const { return injRate; }
+    void setInjRate(double rate);
+
   protected:
     class TickEvent : public Event
     {
@@ -134,9 +133,38 @@ class NetworkTest : public MemObject
     int singleDest;
 
     int trafficType;
+    DestinationTable destTable;
+
+    // The testers may run next to network partitions in other threads,
+    // so each draws from its own generator, seeded from its id
+    Random rng;
     double injRate;
     int precision;
 
+    /**
+     * Arrival process. With on/off bursts, the tester alternates between
+     * on and off periods of geometric length, and only sends in the on
+     * periods, at a rate raised so that the mean offered load is still
+     * injRate. The current period is [burstStart, burstEnd).
+     */
+    Enums::NetworkTestArrival arrival;
+    double burstOnCycles;
+    double burstOffCycles;
+    bool burstOn;
+    Cycles burstStart;
+    Cycles burstEnd;
+    // Cycle of the next packet when not polling, or -1 to sample it
+    double nextArrivalCycle;
+    Cycles lastTickCycle;
+
+    bool bursty() const { return burstOnCycles > 0; }
+    bool senderEnabled() const;
+    double onRate() const;
+    Cycles sampleGeometric(double p);
+    void nextBurstPeriod();
+    double sampleNextArrival(double t);
+    void scheduleTick();
+
     MasterID masterId;
 
     void completeRequest(PacketPtr pkt);
@@ -0,0 +1,236 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/testers/networktest/trafficpattern.hh"
+
+#include <cmath>
+
+#include "base/misc.hh"
+
+using namespace std;
+
+// Number of bits of the ids 0 .. num_dests - 1
+static int
+idBits(int num_dests)
+{
+    int num_bits = 0;
+    while ((1 << num_bits) < num_dests)
+        num_bits++;
+    return num_bits;
+}
+
+static unsigned
+reverseBits(unsigned id, int num_bits)
+{
+    unsigned reverse = 0;
+    for (int i = 0; i < num_bits; i++) {
+        reverse = (reverse << 1) | (id & 1);
+        id >>= 1;
+    }
+    return reverse;
+}
+
+// Rotate the bits of an id right by one
+static unsigned
+rotateBits(unsigned id, int num_bits)
+{
+    if (num_bits < 2)
+        return id;
+    return (id >> 1) | ((id & 1) << (num_bits - 1));
+}
+
+// Rotate the bits of an id left by one, i.e. a perfect shuffle
+static unsigned
+shuffleBits(unsigned id, int num_bits)
+{
+    if (num_bits < 2)
+        return id;
+    unsigned mask = (1u << num_bits) - 1;
+    return ((id << 1) | (id >> (num_bits - 1))) & mask;
+}
+
+// Swap the upper and lower halves of the bits of an id, i.e. rotate
+// them by half their number
+static unsigned
+transposeBits(unsigned id, int num_bits)
+{
+    if (num_bits < 2)
+        return id;
+    int half = num_bits / 2;
+    unsigned mask = (1u << num_bits) - 1;
+    return ((id >> half) | (id << (num_bits - half))) & mask;
+}
+
+// Rank of the image of src among those of all the ids, under a
+// permutation of the num_bits-bit ids. This is the image itself when
+// num_dests is a power of 2.
+template <typename Permute>
+static unsigned
+permutedRank(int src, int num_dests, Permute permute)
+{
+    int num_bits = idBits(num_dests);
+    unsigned image = permute(src, num_bits);
+    unsigned rank = 0;
+    for (int id = 0; id < num_dests; id++) {
+        if (permute(id, num_bits) < image)
+            rank++;
+    }
+    return rank;
+}
+
+DestinationTable
+buildDestinationTable(int type, int src, int num_dests,
+                      const NetworkTestParams *p)
+{
+    DestinationTable table;
+    vector<unsigned> &dests = table.dests;
+
+    // Coordinates of the source for the 2D mesh patterns
+    int radix = (int) sqrt(num_dests);
+    int src_x = src % radix;
+    int src_y = src / radix;
+
+    if ((type == MESH_TORNADO_ || type == MESH_BIT_COMPLEMENT_ ||
+         type == MESH_NEIGHBOR_ || type == MESH_TRANSPOSE_) &&
+        radix * radix != num_dests) {
+        fatal("Traffic type %d is defined on a square 2D mesh, but there "
+              "are %d destinations\n", type, num_dests);
+    }
+
+    switch (type) {
+      case UNIFORM_RANDOM_:
+        for (int dest = 0; dest < num_dests; dest++)
+            dests.push_back(dest);
+        break;
+
+      case TORNADO_:
+        dests.push_back((src + (num_dests + 1) / 2 - 1) % num_dests);
+        break;
+
+      case BIT_COMPLEMENT_:
+        dests.push_back(num_dests - 1 - src);
+        break;
+
+      case BIT_REVERSE_:
+        dests.push_back(permutedRank(src, num_dests, reverseBits));
+        break;
+
+      case BIT_ROTATION_:
+        dests.push_back(permutedRank(src, num_dests, rotateBits));
+        break;
+
+      case NEIGHBOR_:
+        dests.push_back((src + 1) % num_dests);
+        break;
+
+      case SHUFFLE_:
+        dests.push_back(permutedRank(src, num_dests, shuffleBits));
+        break;
+
+      case TRANSPOSE_:
+        dests.push_back(permutedRank(src, num_dests, transposeBits));
+        break;
+
+      case HOTSPOT_:
+        {
+            // Uniform random over the other destinations, plus enough
+            // copies of the hotspot for it to get hotspot_fraction of
+            // the packets
+            double fraction = p->hotspot_fraction;
+            int copies = 1;
+            if (fraction < 1.0) {
+                for (int dest = 0; dest < num_dests; dest++) {
+                    if (dest != p->target_dest)
+                        dests.push_back(dest);
+                }
+                copies = max(1, (int) round(fraction * dests.size() /
+                                            (1 - fraction)));
+            }
+            for (int i = 0; i < copies; i++)
+                dests.push_back(p->target_dest);
+        }
+        break;
+
+      case ALL_TO_ALL_:
+        // Every destination in turn, starting after the source so that
+        // the sources do not all hit the same destination together
+        for (int i = 1; i <= num_dests; i++)
+            dests.push_back((src + i) % num_dests);
+        table.sequential = true;
+        break;
+
+      case INCAST_:
+        dests.push_back(p->target_dest);
+        break;
+
+      case STRIDE_:
+        dests.push_back(((src + p->stride) % num_dests + num_dests) %
+                        num_dests);
+        break;
+
+      case RANDOM_PERMUTATION_:
+        {
+            // Every source shuffles with the same seed and so agrees on
+            // the permutation
+            Random rng(p->pattern_seed);
+            vector<unsigned> perm(num_dests);
+            for (int i = 0; i < num_dests; i++)
+                perm[i] = i;
+            for (int i = num_dests - 1; i > 0; i--)
+                swap(perm[i], perm[rng.random<int>(0, i)]);
+            dests.push_back(perm[src % num_dests]);
+        }
+        break;
+
+      case MESH_TORNADO_:
+        dests.push_back(src_y*radix +
+                        (src_x + (int) ceil(radix/2) - 1) % radix);
+        break;
+
+      case MESH_BIT_COMPLEMENT_:
+        dests.push_back((radix - src_y - 1)*radix + (radix - src_x - 1));
+        break;
+
+      case MESH_NEIGHBOR_:
+        dests.push_back(src_y*radix + (src_x + 1) % radix);
+        break;
+
+      case MESH_TRANSPOSE_:
+        dests.push_back(src_x*radix + src_y);
+        break;
+
+      default:
+        fatal("Unknown Traffic Type: %d\n", type);
+    }
+
+    for (int i = 0; i < dests.size(); i++) {
+        if (dests[i] >= num_dests) {
+            fatal("Traffic type %d sends from %d to %d, but there are only "
+                  "%d destinations\n", type, src, dests[i], num_dests);
+        }
+    }
+
+    return table;
+}
@@ -0,0 +1,103 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPU_NETWORKTEST_TRAFFICPATTERN_HH__
+#define __CPU_NETWORKTEST_TRAFFICPATTERN_HH__
+
+#include <vector>
+
+#include "base/random.hh"
+#include "params/NetworkTest.hh"
+
+enum TrafficType {UNIFORM_RANDOM_ = 0,
+                  TORNADO_ = 1,
+                  BIT_COMPLEMENT_ = 2,
+                  BIT_REVERSE_ = 3,
+                  BIT_ROTATION_ = 4,
+                  NEIGHBOR_ = 5,
+                  SHUFFLE_ = 6,
+                  TRANSPOSE_ = 7,
+                  HOTSPOT_ = 8,
+                  ALL_TO_ALL_ = 9,
+                  INCAST_ = 10,
+                  STRIDE_ = 11,
+                  RANDOM_PERMUTATION_ = 12,
+                  MESH_TORNADO_ = 13,
+                  MESH_BIT_COMPLEMENT_ = 14,
+                  MESH_NEIGHBOR_ = 15,
+                  MESH_TRANSPOSE_ = 16,
+                  NUM_TRAFFIC_PATTERNS_};
+
+/**
+ * The destinations a source sends to under a traffic pattern. Every
+ * packet goes to one entry of the table, picked at random or in turn,
+ * so that the cost per packet is a single lookup whatever the pattern.
+ * Repeating an entry makes it proportionally more likely.
+ */
+class DestinationTable
+{
+  public:
+    DestinationTable()
+        : sequential(false), next(0)
+    {
+    }
+
+    unsigned
+    pick(Random &rng)
+    {
+        if (dests.size() == 1)
+            return dests[0];
+
+        if (sequential) {
+            unsigned dest = dests[next];
+            next = (next + 1) % dests.size();
+            return dest;
+        }
+        return dests[rng.random<size_t>(0, dests.size() - 1)];
+    }
+
+    std::vector<unsigned> dests;
+    bool sequential;
+
+  private:
+    size_t next;
+};
+
+/**
+ * Build the destination table of source src for a traffic type, among
+ * num_dests destinations numbered from 0. The MESH_ patterns are
+ * defined on the coordinates of a square 2D mesh, and need a square
+ * number of destinations; the others only use node ids and work on any
+ * topology. Bit reverse, bit rotation, shuffle and transpose permute the
+ * bits of the ids, over as many bits as the largest id needs; when
+ * num_dests is not a power of 2, a source sends to the rank of its
+ * permuted id among those of all the ids, which keeps them
+ * permutations. Adding a pattern only takes a new TrafficType and a
+ * case here.
+ */
+DestinationTable buildDestinationTable(int type, int src, int num_dests,
+                                       const NetworkTestParams *p);
+
+#endif // __CPU_NETWORKTEST_TRAFFICPATTERN_HH__
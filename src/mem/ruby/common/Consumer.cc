@@ -46,8 +46,5 @@ Consumer::scheduleEventAbsolute(Tick evt_time)
         insertScheduledWakeupTime(evt_time);
     }
 
-    Tick t = em->clockEdge();
-    set<Tick>::iterator bit = m_scheduled_wakeups.begin();
-    set<Tick>::iterator eit = m_scheduled_wakeups.lower_bound(t);
-    m_scheduled_wakeups.erase(bit,eit);
+    m_scheduled_wakeups.removeBefore(em->clockEdge());
 }
@@ -0,0 +1,140 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * A histogram of latencies in log-linear buckets.
+ *
+ * Each power of two is split in SubBuckets linear buckets, so that a
+ * percentile read back from the histogram is within 1/SubBuckets of the
+ * exact one, whatever the range of the samples. Values below SubBuckets
+ * have a bucket of their own. Sampling is a log2 and an increment, and
+ * the histogram has a fixed size, so it can be kept for every packet.
+ */
+
+#ifndef __MEM_RUBY_COMMON_LOGHISTOGRAM_HH__
+#define __MEM_RUBY_COMMON_LOGHISTOGRAM_HH__
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "base/intmath.hh"
+#include "base/types.hh"
+
+class LogHistogram
+{
+  public:
+    static const int SubBits = 3;
+    static const int SubBuckets = 1 << SubBits;
+    // Samples from 2^MaxBits on go to the last bucket
+    static const int MaxBits = 32;
+    static const int NumBuckets = (MaxBits - SubBits + 1) * SubBuckets;
+
+    LogHistogram()
+        : m_counts(NumBuckets, 0), m_samples(0)
+    {
+    }
+
+    static int
+    bucket(uint64_t value)
+    {
+        if (value < SubBuckets)
+            return value;
+        if (value >> MaxBits)
+            return NumBuckets - 1;
+
+        int shift = floorLog2(value) - SubBits;
+        return (shift + 1) * SubBuckets + (value >> shift) - SubBuckets;
+    }
+
+    // Smallest value of a bucket
+    static uint64_t
+    bucketLow(int b)
+    {
+        if (b < SubBuckets)
+            return b;
+        int shift = b / SubBuckets - 1;
+        return (uint64_t)(SubBuckets + b % SubBuckets) << shift;
+    }
+
+    // Largest value of a bucket
+    static uint64_t
+    bucketHigh(int b)
+    {
+        return bucketLow(b + 1) - 1;
+    }
+
+    void
+    sample(uint64_t value)
+    {
+        m_counts[bucket(value)]++;
+        m_samples++;
+    }
+
+    // Add the samples of another histogram
+    void
+    add(const LogHistogram &other)
+    {
+        for (int b = 0; b < NumBuckets; b++)
+            m_counts[b] += other.m_counts[b];
+        m_samples += other.m_samples;
+    }
+
+    /**
+     * The value below which a fraction p of the samples fall, rounded
+     * up to the end of its bucket; 0 if there are no samples.
+     */
+    uint64_t
+    percentile(double p) const
+    {
+        if (m_samples == 0)
+            return 0;
+
+        uint64_t rank = std::max<uint64_t>(1, std::ceil(p * m_samples));
+        uint64_t seen = 0;
+        for (int b = 0; b < NumBuckets; b++) {
+            seen += m_counts[b];
+            if (seen >= rank)
+                return bucketHigh(b);
+        }
+        return bucketHigh(NumBuckets - 1);
+    }
+
+    void
+    reset()
+    {
+        std::fill(m_counts.begin(), m_counts.end(), 0);
+        m_samples = 0;
+    }
+
+    uint64_t count(int b) const { return m_counts[b]; }
+    uint64_t samples() const { return m_samples; }
+
+  private:
+    std::vector<uint64_t> m_counts;
+    uint64_t m_samples;
+};
+
+#endif // __MEM_RUBY_COMMON_LOGHISTOGRAM_HH__
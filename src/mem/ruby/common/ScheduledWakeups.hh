@@ -0,0 +1,103 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * The set of ticks at which a Consumer has a wakeup event scheduled.
+ *
+ * A Consumer only ever has a handful of wakeups pending, and they are
+ * mostly scheduled in increasing order, so they are kept in a sorted
+ * vector whose consumed front is skipped rather than erased. Once the
+ * vector has grown to its working size no further allocation is done.
+ */
+
+#ifndef __MEM_RUBY_COMMON_SCHEDULEDWAKEUPS_HH__
+#define __MEM_RUBY_COMMON_SCHEDULEDWAKEUPS_HH__
+
+#include <algorithm>
+#include <vector>
+
+#include "base/types.hh"
+
+class ScheduledWakeups
+{
+  public:
+    ScheduledWakeups()
+        : m_head(0)
+    {
+    }
+
+    bool
+    contains(Tick time) const
+    {
+        // Most lookups are for the latest wakeup, so search from the back
+        for (size_t i = m_ticks.size(); i > m_head; i--) {
+            if (m_ticks[i - 1] == time)
+                return true;
+            if (m_ticks[i - 1] < time)
+                return false;
+        }
+        return false;
+    }
+
+    void
+    insert(Tick time)
+    {
+        if (empty() || m_ticks.back() < time) {
+            m_ticks.push_back(time);
+            return;
+        }
+
+        std::vector<Tick>::iterator it =
+            std::lower_bound(m_ticks.begin() + m_head, m_ticks.end(), time);
+        if (*it != time)
+            m_ticks.insert(it, time);
+    }
+
+    // Forget the wakeups scheduled before time
+    void
+    removeBefore(Tick time)
+    {
+        while (m_head < m_ticks.size() && m_ticks[m_head] < time)
+            m_head++;
+
+        if (m_head == m_ticks.size()) {
+            m_ticks.clear();
+            m_head = 0;
+        } else if (m_head >= 16 && 2 * m_head >= m_ticks.size()) {
+            m_ticks.erase(m_ticks.begin(), m_ticks.begin() + m_head);
+            m_head = 0;
+        }
+    }
+
+    bool empty() const { return m_head == m_ticks.size(); }
+    size_t size() const { return m_ticks.size() - m_head; }
+
+  private:
+    // Sorted, without duplicates; the entries before m_head are stale
+    std::vector<Tick> m_ticks;
+    size_t m_head;
+};
+
+#endif // __MEM_RUBY_COMMON_SCHEDULEDWAKEUPS_HH__
@@ -29,6 +29,7 @@
 #include <cassert>
 
 #include "base/cprintf.hh"
+#include "base/intmath.hh"
 #include "base/misc.hh"
 #include "base/random.hh"
 #include "base/stl_helpers.hh"
@@ -40,7 +41,9 @@ using namespace std;
 using m5::stl_helpers::operator<<;
 
 MessageBuffer::MessageBuffer(const Params *p)
-    : SimObject(p),
+    : SimObject(p), m_calendar(p->queue == Enums::calendar),
+    m_calendar_width(p->calendar_bucket_width),
+    m_calendar_mask(p->calendar_buckets - 1),
     m_max_size(p->buffer_size), m_time_last_time_size_checked(0),
     m_time_last_time_enqueue(0), m_time_last_time_pop(0),
     m_last_arrival_time(0), m_strict_fifo(p->ordered),
@@ -54,7 +57,16 @@ MessageBuffer::MessageBuffer(const Params *p)
     m_not_avail_count = 0;
     m_priority_rank = 0;
 
-    m_stall_msg_map.clear();
+    if (m_calendar) {
+        fatal_if(!isPowerOf2(p->calendar_buckets), "%s: the number of "
+                 "calendar buckets must be a power of 2\n", name());
+        fatal_if(m_calendar_width == 0, "%s: the calendar buckets must "
+                 "have a non-zero width\n", name());
+        m_calendar_buckets.resize(p->calendar_buckets);
+    }
+    m_calendar_min = 0;
+    m_calendar_size = 0;
+
     m_input_link_id = 0;
     m_vnet_id = 0;
 }
@@ -64,7 +76,7 @@ MessageBuffer::getSize(Tick curTime)
 {
     if (m_time_last_time_size_checked != curTime) {
         m_time_last_time_size_checked = curTime;
-        m_size_last_time_size_checked = m_prio_heap.size();
+        m_size_last_time_size_checked = queueSize();
     }
 
     return m_size_last_time_size_checked;
@@ -87,7 +99,7 @@ MessageBuffer::areNSlotsAvailable(unsigned int n, Tick current_time)
 
     if (m_time_last_time_pop < current_time) {
         // no pops this cycle - heap size is correct
-        current_size = m_prio_heap.size();
+        current_size = queueSize();
     } else {
         if (m_time_last_time_enqueue < current_time) {
             // no enqueues this cycle - m_size_at_cycle_start is correct
@@ -105,7 +117,7 @@ MessageBuffer::areNSlotsAvailable(unsigned int n, Tick current_time)
     } else {
         DPRINTF(RubyQueue, "n: %d, current_size: %d, heap size: %d, "
                 "m_max_size: %d\n",
-                n, current_size, m_prio_heap.size(), m_max_size);
+                n, current_size, queueSize(), m_max_size);
         m_not_avail_count++;
         return false;
     }
@@ -115,13 +127,103 @@ const Message*
 MessageBuffer::peek() const
 {
     DPRINTF(RubyQueue, "Peeking at head of queue.\n");
-    const Message* msg_ptr = m_prio_heap.front().get();
+    const Message* msg_ptr = headMsg().get();
     assert(msg_ptr);
 
     DPRINTF(RubyQueue, "Message: %s\n", (*msg_ptr));
     return msg_ptr;
 }
 
+void
+MessageBuffer::insertMsg(MsgPtr message)
+{
+    if (!m_calendar) {
+        m_prio_heap.push_back(std::move(message));
+        push_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
+        return;
+    }
+
+    // Messages mostly arrive in order, so search for the place of the
+    // message from the back of its bucket
+    Tick arrival_time = message->getLastEnqueueTime();
+    deque<MsgPtr> &bucket = calendarBucket(arrival_time);
+    auto it = bucket.end();
+    while (it != bucket.begin() && *(it - 1) > message) {
+        --it;
+    }
+    bucket.insert(it, std::move(message));
+
+    if (m_calendar_size++ == 0 || arrival_time < m_calendar_min) {
+        m_calendar_min = arrival_time;
+    }
+}
+
+void
+MessageBuffer::removeHead()
+{
+    if (!m_calendar) {
+        pop_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
+        m_prio_heap.pop_back();
+        return;
+    }
+
+    calendarBucket(m_calendar_min).pop_front();
+    if (--m_calendar_size > 0) {
+        calendarFindMin();
+    }
+}
+
+void
+MessageBuffer::calendarFindMin()
+{
+    // The new head is in the first bucket, from that of the old head
+    // on, whose first message arrives in the slot of the bucket
+    Tick slot = m_calendar_min / m_calendar_width;
+    for (unsigned int i = 0; i < m_calendar_buckets.size(); ++i, ++slot) {
+        const deque<MsgPtr> &bucket =
+            m_calendar_buckets[slot & m_calendar_mask];
+        if (!bucket.empty() && bucket.front()->getLastEnqueueTime() <
+            (slot + 1) * m_calendar_width) {
+            m_calendar_min = bucket.front()->getLastEnqueueTime();
+            return;
+        }
+    }
+
+    // Nothing arrives within a whole round of the calendar: take the
+    // earliest of the first messages of the buckets
+    bool found = false;
+    for (const auto &bucket : m_calendar_buckets) {
+        if (bucket.empty()) {
+            continue;
+        }
+        Tick arrival_time = bucket.front()->getLastEnqueueTime();
+        if (!found || arrival_time < m_calendar_min) {
+            m_calendar_min = arrival_time;
+            found = true;
+        }
+    }
+    assert(found);
+}
+
+template <typename F>
+void
+MessageBuffer::forEachQueued(F f) const
+{
+    // f returns true to stop the iteration
+    if (!m_calendar) {
+        for (const MsgPtr &msg : m_prio_heap) {
+            if (f(msg)) return;
+        }
+        return;
+    }
+
+    for (const auto &bucket : m_calendar_buckets) {
+        for (const MsgPtr &msg : bucket) {
+            if (f(msg)) return;
+        }
+    }
+}
+
 // FIXME - move me somewhere else
 Tick
 random_time()
@@ -193,12 +295,11 @@ MessageBuffer::enqueue(MsgPtr message, Tick current_time, Tick delta)
     msg_ptr->setLastEnqueueTime(arrival_time);
     msg_ptr->setMsgCounter(m_msg_counter);
 
-    // Insert the message into the priority heap
-    m_prio_heap.push_back(message);
-    push_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
+    // Insert the message into the priority queue
+    insertMsg(std::move(message));
 
     DPRINTF(RubyQueue, "Enqueue arrival_time: %lld, Message: %s\n",
-            arrival_time, *(message.get()));
+            arrival_time, *msg_ptr);
 
     // Schedule the wakeup
     assert(m_consumer != NULL);
@@ -213,7 +314,7 @@ MessageBuffer::dequeue(Tick current_time)
     assert(isReady(current_time));
 
     // get MsgPtr of the message about to be dequeued
-    MsgPtr message = m_prio_heap.front();
+    const MsgPtr &message = headMsg();
 
     // get the delay cycles
     message->updateDelayedTicks(current_time);
@@ -222,12 +323,11 @@ MessageBuffer::dequeue(Tick current_time)
     // record previous size and time so the current buffer size isn't
     // adjusted until schd cycle
     if (m_time_last_time_pop < current_time) {
-        m_size_at_cycle_start = m_prio_heap.size();
+        m_size_at_cycle_start = queueSize();
         m_time_last_time_pop = current_time;
     }
 
-    pop_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
-    m_prio_heap.pop_back();
+    removeHead();
 
     return delay;
 }
@@ -236,6 +336,10 @@ void
 MessageBuffer::clear()
 {
     m_prio_heap.clear();
+    for (auto &bucket : m_calendar_buckets) {
+        bucket.clear();
+    }
+    m_calendar_size = 0;
 
     m_msg_counter = 0;
     m_time_last_time_enqueue = 0;
@@ -249,14 +353,13 @@ MessageBuffer::recycle(Tick current_time, Tick recycle_latency)
 {
     DPRINTF(RubyQueue, "Recycling.\n");
     assert(isReady(current_time));
-    MsgPtr node = m_prio_heap.front();
-    pop_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
+    MsgPtr node = headMsg();
+    removeHead();
 
     Tick future_time = current_time + recycle_latency;
     node->setLastEnqueueTime(future_time);
 
-    m_prio_heap.back() = node;
-    push_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
+    insertMsg(std::move(node));
     m_consumer->scheduleEventAbsolute(future_time);
 }
 
@@ -269,9 +372,7 @@ MessageBuffer::reanalyzeList(list<MsgPtr> &lt, Tick schdTick)
         m->setLastEnqueueTime(schdTick);
         m->setMsgCounter(m_msg_counter);
 
-        m_prio_heap.push_back(m);
-        push_heap(m_prio_heap.begin(), m_prio_heap.end(),
-                  greater<MsgPtr>());
+        insertMsg(m);
 
         m_consumer->scheduleEventAbsolute(schdTick);
         lt.pop_front();
@@ -282,7 +383,9 @@ void
 MessageBuffer::reanalyzeMessages(Addr addr, Tick current_time)
 {
     DPRINTF(RubyQueue, "ReanalyzeMessages %#x\n", addr);
-    assert(m_stall_msg_map.count(addr) > 0);
+    auto idx = m_stall_index.find(addr);
+    assert(idx != m_stall_index.end());
+    unsigned int i = idx->second;
 
     //
     // Put all stalled messages associated with this address back on the
@@ -290,8 +393,15 @@ MessageBuffer::reanalyzeMessages(Addr addr, Tick current_time)
     // scheduled for the current cycle so that the previously stalled messages
     // will be observed before any younger messages that may arrive this cycle
     //
-    reanalyzeList(m_stall_msg_map[addr], current_time);
-    m_stall_msg_map.erase(addr);
+    reanalyzeList(m_stalled[i].msgs, current_time);
+
+    // Move the last stalled address into the hole
+    m_stall_index.erase(idx);
+    if (i != m_stalled.size() - 1) {
+        m_stalled[i] = std::move(m_stalled.back());
+        m_stall_index[m_stalled[i].addr] = i;
+    }
+    m_stalled.pop_back();
 }
 
 void
@@ -305,11 +415,14 @@ MessageBuffer::reanalyzeAllMessages(Tick current_time)
     // scheduled for the current cycle so that the previously stalled messages
     // will be observed before any younger messages that may arrive this cycle.
     //
-    for (StallMsgMapType::iterator map_iter = m_stall_msg_map.begin();
-         map_iter != m_stall_msg_map.end(); ++map_iter) {
-        reanalyzeList(map_iter->second, current_time);
+    sort(m_stalled.begin(), m_stalled.end(),
+         [](const StalledAddr &a, const StalledAddr &b)
+         { return a.addr < b.addr; });
+    for (auto &stalled : m_stalled) {
+        reanalyzeList(stalled.msgs, current_time);
     }
-    m_stall_msg_map.clear();
+    m_stalled.clear();
+    m_stall_index.clear();
 }
 
 void
@@ -318,7 +431,7 @@ MessageBuffer::stallMessage(Addr addr, Tick current_time)
     DPRINTF(RubyQueue, "Stalling due to %#x\n", addr);
     assert(isReady(current_time));
     assert(getOffset(addr) == 0);
-    MsgPtr message = m_prio_heap.front();
+    MsgPtr message = headMsg();
 
     dequeue(current_time);
 
@@ -327,7 +440,11 @@ MessageBuffer::stallMessage(Addr addr, Tick current_time)
     // Instead the controller is responsible to call reanalyzeMessages when
     // these addresses change state.
     //
-    (m_stall_msg_map[addr]).push_back(message);
+    auto idx = m_stall_index.emplace(addr, m_stalled.size());
+    if (idx.second) {
+        m_stalled.push_back(StalledAddr{addr, list<MsgPtr>()});
+    }
+    m_stalled[idx.first->second].msgs.push_back(std::move(message));
 }
 
 void
@@ -338,38 +455,38 @@ MessageBuffer::print(ostream& out) const
         ccprintf(out, " consumer-yes ");
     }
 
-    vector<MsgPtr> copy(m_prio_heap);
-    sort_heap(copy.begin(), copy.end(), greater<MsgPtr>());
+    vector<MsgPtr> copy;
+    forEachQueued([&copy](const MsgPtr &msg) {
+        copy.push_back(msg);
+        return false;
+    });
+    sort(copy.begin(), copy.end(), greater<MsgPtr>());
     ccprintf(out, "%s] %s", copy, name());
 }
 
 bool
 MessageBuffer::isReady(Tick current_time) const
 {
-    return ((m_prio_heap.size() > 0) &&
-        (m_prio_heap.front()->getLastEnqueueTime() <= current_time));
+    return ((queueSize() > 0) &&
+        (headMsg()->getLastEnqueueTime() <= current_time));
 }
 
 bool
 MessageBuffer::functionalRead(Packet *pkt)
 {
-    // Check the priority heap and read any messages that may
+    // Check the priority queue and read any messages that may
     // correspond to the address in the packet.
-    for (unsigned int i = 0; i < m_prio_heap.size(); ++i) {
-        Message *msg = m_prio_heap[i].get();
-        if (msg->functionalRead(pkt)) return true;
-    }
+    bool found = false;
+    forEachQueued([pkt, &found](const MsgPtr &msg) {
+        found = msg->functionalRead(pkt);
+        return found;
+    });
+    if (found) return true;
 
     // Read the messages in the stall queue that correspond
     // to the address in the packet.
-    for (StallMsgMapType::iterator map_iter = m_stall_msg_map.begin();
-         map_iter != m_stall_msg_map.end();
-         ++map_iter) {
-
-        for (std::list<MsgPtr>::iterator it = (map_iter->second).begin();
-            it != (map_iter->second).end(); ++it) {
-
-            Message *msg = (*it).get();
+    for (auto &stalled : m_stalled) {
+        for (auto &msg : stalled.msgs) {
             if (msg->functionalRead(pkt)) return true;
         }
     }
@@ -381,25 +498,19 @@ MessageBuffer::functionalWrite(Packet *pkt)
 {
     uint32_t num_functional_writes = 0;
 
-    // Check the priority heap and write any messages that may
+    // Check the priority queue and write any messages that may
     // correspond to the address in the packet.
-    for (unsigned int i = 0; i < m_prio_heap.size(); ++i) {
-        Message *msg = m_prio_heap[i].get();
+    forEachQueued([pkt, &num_functional_writes](const MsgPtr &msg) {
         if (msg->functionalWrite(pkt)) {
             num_functional_writes++;
         }
-    }
+        return false;
+    });
 
     // Check the stall queue and write any messages that may
     // correspond to the address in the packet.
-    for (StallMsgMapType::iterator map_iter = m_stall_msg_map.begin();
-         map_iter != m_stall_msg_map.end();
-         ++map_iter) {
-
-        for (std::list<MsgPtr>::iterator it = (map_iter->second).begin();
-            it != (map_iter->second).end(); ++it) {
-
-            Message *msg = (*it).get();
+    for (auto &stalled : m_stalled) {
+        for (auto &msg : stalled.msgs) {
             if (msg->functionalWrite(pkt)) {
                 num_functional_writes++;
             }
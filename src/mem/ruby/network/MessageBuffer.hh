@@ -37,11 +37,15 @@
 #include <algorithm>
 #include <cassert>
 #include <functional>
+#include <deque>
 #include <iostream>
+#include <list>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "debug/RubyQueue.hh"
+#include "enums/MessageBufferQueue.hh"
 #include "mem/ruby/common/Address.hh"
 #include "mem/ruby/common/Consumer.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
@@ -65,10 +69,8 @@ class MessageBuffer : public SimObject
     void
     delayHead(Tick current_time, Tick delta)
     {
-        MsgPtr m = m_prio_heap.front();
-        std::pop_heap(m_prio_heap.begin(), m_prio_heap.end(),
-                      std::greater<MsgPtr>());
-        m_prio_heap.pop_back();
+        MsgPtr m = headMsg();
+        removeHead();
         enqueue(m, current_time, delta);
     }
 
@@ -94,7 +96,7 @@ class MessageBuffer : public SimObject
     //! message queue.  The function assumes that the queue is nonempty.
     const Message* peek() const;
 
-    const MsgPtr &peekMsgPtr() const { return m_prio_heap.front(); }
+    const MsgPtr &peekMsgPtr() const { return headMsg(); }
 
     void enqueue(MsgPtr message, Tick curTime, Tick delta);
 
@@ -103,9 +105,9 @@ class MessageBuffer : public SimObject
     Tick dequeue(Tick current_time);
 
     void recycle(Tick current_time, Tick recycle_latency);
-    bool isEmpty() const { return m_prio_heap.size() == 0; }
-    bool isStallMapEmpty() { return m_stall_msg_map.size() == 0; }
-    unsigned int getStallMapSize() { return m_stall_msg_map.size(); }
+    bool isEmpty() const { return queueSize() == 0; }
+    bool isStallMapEmpty() { return m_stalled.empty(); }
+    unsigned int getStallMapSize() { return m_stalled.size(); }
 
     unsigned int getSize(Tick curTime);
 
@@ -130,17 +132,67 @@ class MessageBuffer : public SimObject
   private:
     void reanalyzeList(std::list<MsgPtr> &, Tick);
 
+    // The messages waiting to arrive are kept either in a binary heap
+    // or in a calendar queue, ordered by (arrival time, msg counter)
+    // in both cases. These hide which one the buffer uses.
+    const MsgPtr &
+    headMsg() const
+    {
+        return m_calendar ? calendarBucket(m_calendar_min).front() :
+                            m_prio_heap.front();
+    }
+
+    unsigned int
+    queueSize() const
+    {
+        return m_calendar ? m_calendar_size : m_prio_heap.size();
+    }
+
+    void insertMsg(MsgPtr message);
+    void removeHead();
+    template <typename F> void forEachQueued(F f) const;
+
+    // Calendar queue: bucket i holds the messages arriving in the time
+    // slots i, i + m_calendar_buckets.size(), ... of m_calendar_width
+    // ticks each, sorted. m_calendar_min is the arrival time of the
+    // head message when the calendar is not empty.
+    std::deque<MsgPtr> &
+    calendarBucket(Tick t)
+    {
+        return m_calendar_buckets[(t / m_calendar_width) & m_calendar_mask];
+    }
+
+    const std::deque<MsgPtr> &
+    calendarBucket(Tick t) const
+    {
+        return m_calendar_buckets[(t / m_calendar_width) & m_calendar_mask];
+    }
+
+    void calendarFindMin();
+
   private:
     // Data Members (m_ prefix)
     //! Consumer to signal a wakeup(), can be NULL
     Consumer* m_consumer;
+    const bool m_calendar;
     std::vector<MsgPtr> m_prio_heap;
 
-    // use a std::map for the stalled messages as this container is
-    // sorted and ensures a well-defined iteration order
-    typedef std::map<Addr, std::list<MsgPtr> > StallMsgMapType;
+    std::vector<std::deque<MsgPtr> > m_calendar_buckets;
+    const Tick m_calendar_width;
+    const Tick m_calendar_mask;
+    Tick m_calendar_min;
+    unsigned int m_calendar_size;
 
-    StallMsgMapType m_stall_msg_map;
+    // Stalled messages, per address. The addresses are kept in a flat
+    // vector with a hash index into it; reanalyzeAllMessages() sorts
+    // them first so that the messages are woken up in address order.
+    struct StalledAddr
+    {
+        Addr addr;
+        std::list<MsgPtr> msgs;
+    };
+    std::vector<StalledAddr> m_stalled;
+    std::unordered_map<Addr, unsigned int> m_stall_index;
 
     const unsigned int m_max_size;
     Tick m_time_last_time_size_checked;
@@ -30,6 +30,8 @@ from m5.params import *
 from m5.proxy import *
 from m5.SimObject import SimObject
 
+class MessageBufferQueue(Enum): vals = ['heap', 'calendar']
+
 class MessageBuffer(SimObject):
     type = 'MessageBuffer'
     cxx_class = 'MessageBuffer'
@@ -38,6 +40,12 @@ class MessageBuffer(SimObject):
     buffer_size = Param.Unsigned(0, "Maximum number of entries to buffer \
                                      (0 allows infinite entries)")
     randomization = Param.Bool(False, "")
+    queue = Param.MessageBufferQueue('heap', "queue of the messages waiting "
+        "to arrive: a binary heap or a calendar of time buckets")
+    calendar_buckets = Param.Unsigned(64, "number of calendar time buckets "
+        "(a power of 2)")
+    calendar_bucket_width = Param.Latency('500ps', "time covered by one "
+        "calendar bucket")
 
     master = MasterPort("Master port to MessageBuffer receiver")
     slave = SlavePort("Slave port from MessageBuffer sender")
@@ -45,6 +45,8 @@ class RubyNetwork(ClockedObject):
            "the number of virtual networks should be one more than the "
            "highest numbered vnet in use.")
     control_msg_size = Param.Int(8, "")
+    routing_table_cache = Param.String("", "file caching the routing "
+        "tables across runs with the same topology, empty to disable")
     ruby_system = Param.RubySystem("")
 
     routers = VectorParam.BasicRouter("Network routers")
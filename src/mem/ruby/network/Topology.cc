@@ -26,8 +26,18 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <queue>
 
+#include "base/misc.hh"
 #include "base/trace.hh"
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/common/NetDest.hh"
@@ -39,6 +49,35 @@ using namespace std;
 
 const int INFINITE_LATENCY = 10000; // Yes, this is a big hack
 
+// Layout of the routing table cache file. The header is followed, for
+// each link that gets a routing table, by its source and destination
+// switch and a bitmap of the machines it routes to. The file is only
+// meant to be read back on the host that wrote it.
+static const uint64_t ROUTING_TABLE_CACHE_MAGIC =
+    0x3145484341435452ull; // "RTCACHE1"
+
+struct RoutingTableCacheHeader
+{
+    uint64_t magic;
+    uint64_t hash;
+    uint32_t num_links;
+    uint32_t num_machines;
+};
+
+// Machines in NodeID order
+static vector<MachineID>
+machine_ids()
+{
+    vector<MachineID> ids;
+    for (int m = 0; m < MachineType_NUM; m++) {
+        for (NodeID i = 0; i < MachineType_base_count((MachineType)m); i++) {
+            MachineID mach = {(MachineType)m, i};
+            ids.push_back(mach);
+        }
+    }
+    return ids;
+}
+
 // Note: In this file, we use the first 2*m_nodes SwitchIDs to
 // represent the input and output endpoint links.  These really are
 // not 'switches', as they will not have a Switch object allocated for
@@ -48,9 +87,11 @@ const int INFINITE_LATENCY = 10000; // Yes, this is a big hack
 
 Topology::Topology(uint32_t num_routers,
                    const vector<BasicExtLink *> &ext_links,
-                   const vector<BasicIntLink *> &int_links)
+                   const vector<BasicIntLink *> &int_links,
+                   const string &routing_table_cache)
     : m_nodes(ext_links.size()), m_number_of_switches(num_routers),
-      m_ext_link_vector(ext_links), m_int_link_vector(int_links)
+      m_ext_link_vector(ext_links), m_int_link_vector(int_links),
+      m_routing_table_cache(routing_table_cache)
 {
     // Total nodes/controllers in network
     assert(m_nodes > 1);
@@ -111,44 +152,41 @@ Topology::createLinks(Network *net)
         max_switch_id = max(max_switch_id, src_dest.first);
         max_switch_id = max(max_switch_id, src_dest.second);        
     }
-
-    // Initialize weight, latency, and inter switched vectors
     int num_switches = max_switch_id+1;
-    Matrix topology_weights(num_switches,
-            vector<int>(num_switches, INFINITE_LATENCY));
-    Matrix component_latencies(num_switches,
-            vector<int>(num_switches, -1));
-    Matrix component_inter_switches(num_switches,
-            vector<int>(num_switches, 0));
-
-    // Set identity weights to zero
-    for (int i = 0; i < topology_weights.size(); i++) {
-        topology_weights[i][i] = 0;
+
+    // The routing tables only depend on the topology, so they can be
+    // reused from an earlier run with the same one
+    vector<NetDest> routing_tables;
+    uint64_t hash = topology_hash();
+    if (m_routing_table_cache.empty() ||
+        !read_routing_tables(hash, routing_tables)) {
+        vector<int> dist = shortest_path(num_switches);
+
+        // The link map is ordered by (src, dest), so the links are made
+        // in the same order as the rows of a weight matrix would give
+        for (LinkMap::const_iterator i = m_link_map.begin();
+             i != m_link_map.end(); ++i) {
+            int src = (*i).first.first;
+            int dst = (*i).first.second;
+            int weight = (*i).second.link->m_weight;
+            if (weight > 0 && weight != INFINITE_LATENCY) {
+                routing_tables.push_back(shortest_path_to_node(src, dst,
+                    weight, num_switches, dist));
+            }
+        }
+
+        if (!m_routing_table_cache.empty())
+            write_routing_tables(hash, routing_tables);
     }
 
-    // Fill in the topology weights and bandwidth multipliers
+    // Walk topology and hookup the links
+    int table = 0;
     for (LinkMap::const_iterator i = m_link_map.begin();
          i != m_link_map.end(); ++i) {
-        std::pair<int, int> src_dest = (*i).first;
-        BasicLink* link = (*i).second.link;
-        int src = src_dest.first;
-        int dst = src_dest.second;
-        component_latencies[src][dst] = link->m_latency;
-        topology_weights[src][dst] = link->m_weight;
-    }
-        
-    // Walk topology and hookup the links
-    Matrix dist = shortest_path(topology_weights, component_latencies,
-                                component_inter_switches);
-
-    for (int i = 0; i < topology_weights.size(); i++) {
-        for (int j = 0; j < topology_weights[i].size(); j++) {
-            int weight = topology_weights[i][j];
-            if (weight > 0 && weight != INFINITE_LATENCY) {
-                NetDest destination_set =
-                        shortest_path_to_node(i, j, topology_weights, dist);
-                makeLink(net, i, j, destination_set);
-            }
+        int weight = (*i).second.link->m_weight;
+        if (weight > 0 && weight != INFINITE_LATENCY) {
+            makeLink(net, (*i).first.first, (*i).first.second,
+                     routing_tables[table++]);
         }
     }
 }
@@ -212,66 +250,77 @@ Topology::makeLink(Network *net, SwitchID src, SwitchID dest,
     }
 }
 
-// The following all-pairs shortest path algorithm is based on the
-// discussion from Cormen et al., Chapter 26.1.
-void
-Topology::extend_shortest_path(Matrix &current_dist, Matrix &latencies,
-    Matrix &inter_switches)
+// Distances from every switch to every destination endpoint, found
+// with one Dijkstra search per destination over the reversed links.
+// Only the distances to the endpoints are ever needed, so this is
+// O(nodes * links * log(switches)) rather than all-pairs O(switches^3).
+// The distance from switch s to destination d is at
+// dist[d * num_switches + s], INFINITE_LATENCY if there is no path.
+vector<int>
+Topology::shortest_path(int num_switches)
 {
-    bool change = true;
-    int nodes = current_dist.size();
-
-    while (change) {
-        change = false;
-        for (int i = 0; i < nodes; i++) {
-            for (int j = 0; j < nodes; j++) {
-                int minimum = current_dist[i][j];
-                int previous_minimum = minimum;
-                int intermediate_switch = -1;
-                for (int k = 0; k < nodes; k++) {
-                    minimum = min(minimum,
-                        current_dist[i][k] + current_dist[k][j]);
-                    if (previous_minimum != minimum) {
-                        intermediate_switch = k;
-                        inter_switches[i][j] =
-                            inter_switches[i][k] +
-                            inter_switches[k][j] + 1;
-                    }
-                    previous_minimum = minimum;
-                }
-                if (current_dist[i][j] != minimum) {
-                    change = true;
-                    current_dist[i][j] = minimum;
-                    assert(intermediate_switch >= 0);
-                    assert(intermediate_switch < latencies[i].size());
-                    latencies[i][j] = latencies[i][intermediate_switch] +
-                        latencies[intermediate_switch][j];
+    // Incoming links of each switch, in compressed-row form
+    vector<int> in_offset(num_switches + 1, 0);
+    for (LinkMap::const_iterator i = m_link_map.begin();
+         i != m_link_map.end(); ++i) {
+        in_offset[(*i).first.second + 1]++;
+    }
+    for (int s = 0; s < num_switches; s++)
+        in_offset[s + 1] += in_offset[s];
+
+    vector<int> in_src(m_link_map.size());
+    vector<int> in_weight(m_link_map.size());
+    vector<int> fill(in_offset.begin(), in_offset.end() - 1);
+    for (LinkMap::const_iterator i = m_link_map.begin();
+         i != m_link_map.end(); ++i) {
+        int idx = fill[(*i).first.second]++;
+        in_src[idx] = (*i).first.first;
+        in_weight[idx] = (*i).second.link->m_weight;
+    }
+
+    // The output endpoints of the machines are numbered from
+    // MachineType_base_number(MachineType_NUM), see shortest_path_to_node
+    int max_machines = MachineType_base_number(MachineType_NUM);
+    vector<int> dist(max_machines * num_switches, INFINITE_LATENCY);
+
+    typedef pair<int, int> DistSwitch;
+    priority_queue<DistSwitch, vector<DistSwitch>,
+                   greater<DistSwitch> > frontier;
+
+    for (int d = 0; d < max_machines; d++) {
+        int final = d + max_machines;
+        if (final >= num_switches)
+            continue;
+
+        int *d_dist = &dist[d * num_switches];
+        d_dist[final] = 0;
+        frontier.push(DistSwitch(0, final));
+
+        while (!frontier.empty()) {
+            DistSwitch top = frontier.top();
+            frontier.pop();
+            int next = top.second;
+            if (top.first > d_dist[next])
+                continue;
+
+            for (int idx = in_offset[next]; idx < in_offset[next + 1];
+                 idx++) {
+                int src = in_src[idx];
+                int src_dist = top.first + in_weight[idx];
+                if (src_dist < d_dist[src]) {
+                    d_dist[src] = src_dist;
+                    frontier.push(DistSwitch(src_dist, src));
                 }
             }
         }
     }
-}
 
-Matrix
-Topology::shortest_path(const Matrix &weights, Matrix &latencies,
-                        Matrix &inter_switches)
-{
-    Matrix dist = weights;
-    extend_shortest_path(dist, latencies, inter_switches);
     return dist;
 }
 
-bool
-Topology::link_is_shortest_path_to_node(SwitchID src, SwitchID next,
-                                        SwitchID final, const Matrix &weights,
-                                        const Matrix &dist)
-{
-    return weights[src][next] + dist[next][final] == dist[src][final];
-}
-
 NetDest
-Topology::shortest_path_to_node(SwitchID src, SwitchID next,
-                                const Matrix &weights, const Matrix &dist)
+Topology::shortest_path_to_node(SwitchID src, SwitchID next, int weight,
+                                int num_switches, const vector<int> &dist)
 {
     NetDest result;
     int d = 0;
@@ -283,13 +332,12 @@ Topology::shortest_path_to_node(SwitchID src, SwitchID next,
 
     for (int m = 0; m < machines; m++) {
         for (NodeID i = 0; i < MachineType_base_count((MachineType)m); i++) {
-            // we use "d+max_machines" below since the "destination"
-            // switches for the machines are numbered
+            // the "destination" switches for the machines are numbered
             // [MachineType_base_number(MachineType_NUM)...
             //  2*MachineType_base_number(MachineType_NUM)-1] for the
-            // component network
-            if (link_is_shortest_path_to_node(src, next, d + max_machines,
-                    weights, dist)) {
+            // component network; dist is indexed by machine
+            const int *d_dist = &dist[d * num_switches];
+            if (weight + d_dist[next] == d_dist[src]) {
                 MachineID mach = {(MachineType)m, i};
                 result.add(mach);
             }
@@ -305,3 +353,145 @@ Topology::shortest_path_to_node(SwitchID src, SwitchID next,
 
     return result;
 }
+
+// FNV-1a over everything the routing tables are computed from: the
+// machines and every link with its weight
+uint64_t
+Topology::topology_hash() const
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto mix = [&hash](uint64_t value) {
+        for (int byte = 0; byte < 8; byte++) {
+            hash ^= (value >> (8 * byte)) & 0xff;
+            hash *= 0x100000001b3ull;
+        }
+    };
+
+    mix(m_nodes);
+    for (int m = 0; m < MachineType_NUM; m++)
+        mix(MachineType_base_count((MachineType)m));
+
+    mix(m_link_map.size());
+    for (LinkMap::const_iterator i = m_link_map.begin();
+         i != m_link_map.end(); ++i) {
+        mix((*i).first.first);
+        mix((*i).first.second);
+        mix((*i).second.link->m_weight);
+    }
+    return hash;
+}
+
+bool
+Topology::read_routing_tables(uint64_t hash, vector<NetDest> &tables)
+{
+    int fd = open(m_routing_table_cache.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < sizeof(RoutingTableCacheHeader)) {
+        close(fd);
+        return false;
+    }
+
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return false;
+
+    const RoutingTableCacheHeader *header =
+        (const RoutingTableCacheHeader *)map;
+    vector<MachineID> machines = machine_ids();
+    int num_words = (machines.size() + 63) / 64;
+    size_t entry_size = 2 * sizeof(uint32_t) + num_words * sizeof(uint64_t);
+
+    bool valid = header->magic == ROUTING_TABLE_CACHE_MAGIC &&
+        header->hash == hash &&
+        header->num_machines == machines.size() &&
+        st.st_size == sizeof(*header) + header->num_links * entry_size;
+
+    const uint8_t *entry = (const uint8_t *)(header + 1);
+    LinkMap::const_iterator link = m_link_map.begin();
+    for (int l = 0; valid && l < header->num_links; l++) {
+        // Skip the links that do not get a routing table
+        while (link != m_link_map.end() &&
+               (link->second.link->m_weight <= 0 ||
+                link->second.link->m_weight == INFINITE_LATENCY)) {
+            ++link;
+        }
+
+        const uint32_t *ends = (const uint32_t *)entry;
+        if (link == m_link_map.end() || ends[0] != link->first.first ||
+            ends[1] != link->first.second) {
+            valid = false;
+            break;
+        }
+
+        const uint64_t *bits = (const uint64_t *)(ends + 2);
+        NetDest table;
+        for (int d = 0; d < machines.size(); d++) {
+            if (bits[d / 64] & (1ull << (d % 64)))
+                table.add(machines[d]);
+        }
+        tables.push_back(table);
+
+        entry += entry_size;
+        ++link;
+    }
+    munmap(map, st.st_size);
+
+    if (!valid) {
+        warn("Ignoring stale routing table cache %s\n",
+             m_routing_table_cache);
+        tables.clear();
+        return false;
+    }
+
+    inform("Using routing tables cached in %s\n", m_routing_table_cache);
+    return true;
+}
+
+void
+Topology::write_routing_tables(uint64_t hash, const vector<NetDest> &tables)
+{
+    vector<MachineID> machines = machine_ids();
+    int num_words = (machines.size() + 63) / 64;
+
+    RoutingTableCacheHeader header;
+    header.magic = ROUTING_TABLE_CACHE_MAGIC;
+    header.hash = hash;
+    header.num_links = tables.size();
+    header.num_machines = machines.size();
+
+    // Write to a temporary file first, so that concurrent runs never
+    // see a partially written cache
+    string tmp = csprintf("%s.%d", m_routing_table_cache, getpid());
+    ofstream out(tmp.c_str(), ios::binary);
+    out.write((const char *)&header, sizeof(header));
+
+    int table = 0;
+    for (LinkMap::const_iterator i = m_link_map.begin();
+         i != m_link_map.end(); ++i) {
+        int weight = (*i).second.link->m_weight;
+        if (weight <= 0 || weight == INFINITE_LATENCY)
+            continue;
+
+        uint32_t ends[2] = { (uint32_t)(*i).first.first,
+                             (uint32_t)(*i).first.second };
+        vector<uint64_t> bits(num_words, 0);
+        for (int d = 0; d < machines.size(); d++) {
+            if (tables[table].isElement(machines[d]))
+                bits[d / 64] |= 1ull << (d % 64);
+        }
+        out.write((const char *)ends, sizeof(ends));
+        out.write((const char *)&bits[0], num_words * sizeof(uint64_t));
+        table++;
+    }
+    out.close();
+
+    if (!out || rename(tmp.c_str(), m_routing_table_cache.c_str()) != 0) {
+        warn("Could not write routing table cache %s\n",
+             m_routing_table_cache);
+        unlink(tmp.c_str());
+    }
+}
@@ -51,8 +51,6 @@
 class NetDest;
 class Network;
 
-typedef std::vector<std::vector<int> > Matrix;
-
 typedef int PortDirection;
 
 struct LinkEntry 
@@ -69,7 +67,8 @@ class Topology
 {
   public:
     Topology(uint32_t num_routers, const std::vector<BasicExtLink *> &ext_links,
-             const std::vector<BasicIntLink *> &int_links);
+             const std::vector<BasicIntLink *> &int_links,
+             const std::string &routing_table_cache = "");
 
     uint32_t numSwitches() const { return m_number_of_switches; }
     void createLinks(Network *net);
@@ -84,18 +83,17 @@ class Topology
     void makeLink(Network *net, SwitchID src, SwitchID dest,
                   const NetDest& routing_table_entry);
 
-    // Helper functions based on chapter 29 of Cormen et al.
-    void extend_shortest_path(Matrix &current_dist, Matrix &latencies,
-                              Matrix &inter_switches);
-
-    std::vector<std::vector<int>> shortest_path(const Matrix &weights,
-            Matrix &latencies, Matrix &inter_switches);
+    std::vector<int> shortest_path(int num_switches);
 
-    bool link_is_shortest_path_to_node(SwitchID src, SwitchID next,
-            SwitchID final, const Matrix &weights, const Matrix &dist);
+    NetDest shortest_path_to_node(SwitchID src, SwitchID next, int weight,
+                                  int num_switches,
+                                  const std::vector<int> &dist);
 
-    NetDest shortest_path_to_node(SwitchID src, SwitchID next,
-                                  const Matrix &weights, const Matrix &dist);
+    // Routing table cache, see createLinks()
+    uint64_t topology_hash() const;
+    bool read_routing_tables(uint64_t hash, std::vector<NetDest> &tables);
+    void write_routing_tables(uint64_t hash,
+                              const std::vector<NetDest> &tables);
 
     const uint32_t m_nodes;
     const uint32_t m_number_of_switches;
@@ -104,6 +102,8 @@ class Topology
     std::vector<BasicIntLink*> m_int_link_vector;
 
     LinkMap m_link_map;
+
+    std::string m_routing_table_cache;
 };
 
 inline std::ostream&
@@ -38,17 +38,28 @@ enum VC_state_type {IDLE_, VC_AB_, ACTIVE_, NUM_VC_STATE_TYPE_};
 enum VNET_type {CTRL_VNET_, DATA_VNET_, NULL_VNET_, NUM_VNET_TYPE_};
 enum flit_stage {I_, VA_, SA_, ST_, LT_, NUM_FLIT_STAGE_};
 enum port_direction_type {L_ = 0, W_ = 1, S_ = 2, E_ = 3, N_ = 4, UNKNOWN_ = 5, NUM_PORT_DIRECTION_TYPE_};
-enum RoutingAlgorithm { TABLE_ = 0, XY_ = 1, RANDOM_ = 2, TURN_MODEL_ = 3, NUM_ROUTING_ALGORITHM_};
+enum RoutingAlgorithm { TABLE_ = 0, XY_ = 1, RANDOM_ = 2, TURN_MODEL_ = 3,
+                        ECMP_ = 4, ADAPTIVE_ = 5, NUM_ROUTING_ALGORITHM_};
 
 struct RouteInfo
 {
+    int vnet;
+
     // destination format for table-based routing
     NetDest net_dest;
 
+    // source of the packet, used to hash flows onto paths
+    int src_ni;
+    int src_router;
+
     // destination format for topology-specific routing
     int dest_ni;
     int dest_router;
     int hops;
+
+    // sent to all of net_dest as one packet, which the routers fork
+    // where the paths to the destinations diverge
+    bool multicast;
 };
 
 #define INFINITE_ 10000
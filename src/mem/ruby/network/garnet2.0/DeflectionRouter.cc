@@ -0,0 +1,291 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/ruby/network/garnet2.0/DeflectionRouter.hh"
+
+#include <algorithm>
+
+#include "base/misc.hh"
+#include "debug/RubyNetwork.hh"
+#include "mem/ruby/network/garnet2.0/InputUnit.hh"
+#include "mem/ruby/network/garnet2.0/NetworkLink.hh"
+#include "mem/ruby/network/garnet2.0/OutputUnit.hh"
+#include "mem/ruby/network/garnet2.0/RoutingUnit.hh"
+
+using namespace std;
+
+// Oldest first, a flit being as old as its packet, then by source and
+// position in the packet, so that all routers agree on the order
+static bool
+older(flit *f1, flit *f2)
+{
+    if (f1->get_enqueue_time() != f2->get_enqueue_time())
+        return f1->get_enqueue_time() < f2->get_enqueue_time();
+    if (f1->get_route().src_ni != f2->get_route().src_ni)
+        return f1->get_route().src_ni < f2->get_route().src_ni;
+    return f1->get_id() < f2->get_id();
+}
+
+DeflectionRouter::DeflectionRouter(const Params *p)
+    : Router(p), m_deflect_round_robin(0), m_inject_round_robin(0),
+      m_num_flits_routed(0), m_num_flits_deflected(0)
+{
+}
+
+void
+DeflectionRouter::startup()
+{
+    Router::startup();
+
+    int num_network_inports = 0;
+    for (int inport = 0; inport < m_input_unit.size(); inport++) {
+        if (m_input_unit[inport]->get_direction() != L_)
+            num_network_inports++;
+    }
+
+    m_network_outports.clear();
+    for (int outport = 0; outport < m_output_unit.size(); outport++) {
+        if (m_output_unit[outport]->get_direction() != L_)
+            m_network_outports.push_back(outport);
+    }
+
+    fatal_if(m_network_outports.size() < num_network_inports,
+             "Deflection router %d has %d network inports but only %d "
+             "network outports\n", m_id, num_network_inports,
+             m_network_outports.size());
+
+    m_outport_busy.resize(m_output_unit.size());
+    m_vc_round_robin.resize(m_input_unit.size(), 0);
+}
+
+void
+DeflectionRouter::wakeup()
+{
+    DPRINTF(RubyNetwork, "DeflectionRouter %d woke up\n", m_id);
+
+    Cycles curTime = curCycle();
+    fill(m_outport_busy.begin(), m_outport_busy.end(), false);
+
+    for (int outport = 0; outport < m_output_unit.size(); outport++) {
+        m_output_unit[outport]->discard_credits();
+    }
+
+    // Flits from the NIs are buffered in the VCs of the local inports,
+    // while those on the network ports have to leave this cycle
+    vector<flit *> arrivals;
+    for (int inport = 0; inport < m_input_unit.size(); inport++) {
+        InputUnit *input_unit = m_input_unit[inport];
+        if (input_unit->get_direction() == L_) {
+            input_unit->wakeup();
+            continue;
+        }
+
+        NetworkLink *in_link = input_unit->get_in_link();
+        if (in_link->isReady(curTime)) {
+            flit *t_flit = in_link->consumeLink();
+            t_flit->increment_hops(); // for stats
+            arrivals.push_back(t_flit);
+        }
+    }
+
+    sort(arrivals.begin(), arrivals.end(), older);
+
+    for (int i = 0; i < arrivals.size(); i++) {
+        flit *t_flit = arrivals[i];
+        int outport = productive_outport(t_flit);
+        if (outport == -1) {
+            outport = deflection_outport();
+            m_num_flits_deflected++;
+        }
+
+        // There are at least as many network outports as network inports
+        assert(outport != -1);
+        send_flit(t_flit, outport);
+    }
+
+    // Inject into the ports left free, starting from a different local
+    // inport every cycle
+    bool pending = false;
+    int num_inports = m_input_unit.size();
+    for (int i = 0; i < num_inports; i++) {
+        int inport = (m_inject_round_robin + i) % num_inports;
+        if (m_input_unit[inport]->get_direction() == L_)
+            pending |= inject(inport);
+    }
+    m_inject_round_robin = (m_inject_round_robin + 1) % num_inports;
+
+    // Nothing else wakes the router up for flits that could not leave
+    if (pending)
+        schedule_wakeup(Cycles(1));
+}
+
+// A free output port on a minimal path to the destination, or -1
+int
+DeflectionRouter::productive_outport(flit *t_flit)
+{
+    const OutportLookupTable &lookup = m_routing_unit->getOutportLookup();
+    NodeID dest_ni = t_flit->get_route().dest_ni;
+
+    int num_candidates = lookup.getNumCandidates(dest_ni);
+    for (int i = 0; i < num_candidates; i++) {
+        int outport = lookup.getCandidate(dest_ni, i);
+        if (!m_outport_busy[outport])
+            return outport;
+    }
+
+    return -1;
+}
+
+// A free network output port, or -1. The ports are handed out round
+// robin so that deflections spread over them.
+int
+DeflectionRouter::deflection_outport()
+{
+    int num_ports = m_network_outports.size();
+    for (int i = 0; i < num_ports; i++) {
+        int idx = (m_deflect_round_robin + i) % num_ports;
+        int outport = m_network_outports[idx];
+        if (!m_outport_busy[outport]) {
+            m_deflect_round_robin = (idx + 1) % num_ports;
+            return outport;
+        }
+    }
+
+    return -1;
+}
+
+void
+DeflectionRouter::send_flit(flit *t_flit, int outport)
+{
+    DPRINTF(RubyNetwork, "DeflectionRouter %d sends flit %d of NI %d "
+            "to NI %d on outport %d\n", m_id, t_flit->get_id(),
+            t_flit->get_route().src_ni, t_flit->get_route().dest_ni,
+            outport);
+
+    m_outport_busy[outport] = true;
+    t_flit->set_outport(outport);
+    t_flit->advance_stage(LT_, curCycle());
+    t_flit->set_time(curCycle());
+
+    // This will take care of waking up the Network Link
+    m_output_unit[outport]->insert_flit(t_flit);
+    m_num_flits_routed++;
+}
+
+// Inject a flit of a local inport, if a port is free. Returns whether
+// flits ready to leave remain in the inport.
+bool
+DeflectionRouter::inject(int inport)
+{
+    InputUnit *input_unit = m_input_unit[inport];
+    Cycles curTime = curCycle();
+
+    int invc = -1;
+    for (int i = 0; i < m_num_vcs; i++) {
+        int vc = (m_vc_round_robin[inport] + i) % m_num_vcs;
+        if (input_unit->need_stage(vc, SA_, curTime)) {
+            invc = vc;
+            break;
+        }
+    }
+
+    if (invc == -1)
+        return false;
+
+    int outport = productive_outport(input_unit->peekTopFlit(invc));
+    if (outport == -1) {
+        outport = deflection_outport();
+        if (outport == -1)
+            return true;
+        m_num_flits_deflected++;
+    }
+
+    flit *t_flit = input_unit->getTopFlit(invc);
+    send_flit(t_flit, outport);
+    m_vc_round_robin[inport] = (invc + 1) % m_num_vcs;
+
+    // Send a credit back, along with the information that the VC is
+    // now idle after the tail flit
+    if (t_flit->get_type() == TAIL_ || t_flit->get_type() == HEAD_TAIL_) {
+        assert(!input_unit->isReady(invc, curTime));
+        input_unit->set_vc_idle(invc, curTime);
+        input_unit->increment_credit(invc, true, curTime);
+    } else {
+        input_unit->increment_credit(invc, false, curTime);
+    }
+
+    for (int vc = 0; vc < m_num_vcs; vc++) {
+        if (input_unit->need_stage(vc, SA_, curTime))
+            return true;
+    }
+
+    return false;
+}
+
+void
+DeflectionRouter::regStats()
+{
+    Router::regStats();
+
+    m_flits_routed
+        .name(name() + ".flits_routed")
+        .flags(Stats::nozero)
+    ;
+
+    m_flits_deflected
+        .name(name() + ".flits_deflected")
+        .flags(Stats::nozero)
+    ;
+
+    m_deflection_rate
+        .name(name() + ".deflection_rate")
+        .desc("fraction of the flits routed away from a minimal path")
+    ;
+    m_deflection_rate = m_flits_deflected / m_flits_routed;
+}
+
+void
+DeflectionRouter::collateStats()
+{
+    Router::collateStats();
+
+    m_flits_routed = m_num_flits_routed;
+    m_flits_deflected = m_num_flits_deflected;
+}
+
+void
+DeflectionRouter::resetStats()
+{
+    Router::resetStats();
+
+    m_num_flits_routed = 0;
+    m_num_flits_deflected = 0;
+}
+
+DeflectionRouter *
+GarnetDeflectionRouterParams::create()
+{
+    return new DeflectionRouter(this);
+}
@@ -0,0 +1,91 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_DEFLECTION_ROUTER_HH__
+#define __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_DEFLECTION_ROUTER_HH__
+
+#include <vector>
+
+#include "mem/ruby/network/garnet2.0/Router.hh"
+#include "params/GarnetDeflectionRouter.hh"
+
+/**
+ * Bufferless deflection router, in the style of BLESS. Flits arriving
+ * on a network port are not buffered: every cycle, each of them leaves
+ * on some output port. They are routed independently, oldest first,
+ * each taking a free productive (minimal) port if one is left and being
+ * deflected to any free network port otherwise. Since a router has at
+ * least as many network outports as network inports, there is always
+ * one. Giving the oldest flit priority at every router ensures that it
+ * reaches its destination, so the network is free of livelock.
+ *
+ * Flits from the NIs wait in the VCs of the local inports, which are
+ * the only buffers of the router, and are injected when an output port
+ * is left free by the flits in flight. No credits are exchanged between
+ * routers. As the flits of a packet may take different paths, the NIs
+ * reassemble packets from flits arriving in any order.
+ *
+ * The router has a single-cycle pipeline, and routes with the minimal
+ * candidates of the routing table whatever the routing algorithm.
+ */
+class DeflectionRouter : public Router
+{
+  public:
+    typedef GarnetDeflectionRouterParams Params;
+    DeflectionRouter(const Params *p);
+
+    void startup();
+    void wakeup();
+
+    void regStats();
+    void collateStats();
+    void resetStats();
+
+    double get_crossbar_activity() { return m_num_flits_routed; }
+    double get_flits_routed() { return m_num_flits_routed; }
+    double get_flits_deflected() { return m_num_flits_deflected; }
+
+  private:
+    int productive_outport(flit *t_flit);
+    int deflection_outport();
+    void send_flit(flit *t_flit, int outport);
+    bool inject(int inport);
+
+    // Output ports already taken this cycle
+    std::vector<bool> m_outport_busy;
+    std::vector<int> m_network_outports;
+    int m_deflect_round_robin;
+    int m_inject_round_robin;
+    std::vector<int> m_vc_round_robin; // per local inport
+
+    double m_num_flits_routed;
+    double m_num_flits_deflected;
+
+    Stats::Scalar m_flits_routed;
+    Stats::Scalar m_flits_deflected;
+    Stats::Formula m_deflection_rate;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_DEFLECTION_ROUTER_HH__
@@ -38,6 +38,7 @@ GarnetIntLink::GarnetIntLink(const Params *p)
     m_credit_links[0] = p->credit_links[0];
     m_network_links[1] = p->network_links[1];
     m_credit_links[1] = p->credit_links[1];
+    m_bypass_hops = p->bypass_hops;
 }
 
 void
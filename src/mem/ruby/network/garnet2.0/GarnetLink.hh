@@ -54,6 +54,8 @@ class GarnetIntLink : public BasicLink
   protected:
     NetworkLink* m_network_links[2];
     CreditLink* m_credit_links[2];
+    // Routers bypassed by an express link, 0 for other links
+    int m_bypass_hops;
 };
 
 inline std::ostream&
@@ -42,10 +42,16 @@ class NetworkLink(ClockedObject):
                               "virtual channels per virtual network")
     virt_nets = Param.Int(Parent.number_of_virtual_networks,
                           "number of virtual networks")
+    width = Param.UInt32(Parent.width, "link width in bytes per cycle")
+    flit_size = Param.UInt32(Parent.ni_flit_size, "flit size in bytes")
+    serdes_latency = Param.Cycles(Parent.serdes_latency,
+        "latency of the serializer and of the deserializer of a narrow link")
 
 class CreditLink(NetworkLink):
     type = 'CreditLink'
     cxx_header = "mem/ruby/network/garnet2.0/CreditLink.hh"
+    # Credits travel on a sideband, a credit per cycle
+    width = 0
 
 # Interior fixed pipeline links between routers
 class GarnetIntLink(BasicIntLink):
@@ -67,6 +73,13 @@ class GarnetIntLink(BasicIntLink):
     cls.append(CreditLink());
     credit_links = VectorParam.CreditLink(cls, "backward flow-control links")
 
+    # A link narrower than a flit serializes it over several cycles
+    width = Param.UInt32(0, "width in bytes per cycle (0: a flit per cycle)")
+
+    # An express link joins two routers bypass_hops + 1 hops apart along a
+    # straight path, and skips the pipelines of the routers in between
+    bypass_hops = Param.UInt32(0, "routers bypassed by an express link")
+
 # Exterior fixed pipeline links between a router and a controller
 class GarnetExtLink(BasicExtLink):
     type = 'GarnetExtLink'
@@ -86,3 +99,6 @@ class GarnetExtLink(BasicExtLink):
     # Out uni-directional link
     cls.append(CreditLink());
     credit_links = VectorParam.CreditLink(cls, "backward flow-control links")
+
+    # A link narrower than a flit serializes it over several cycles
+    width = Param.UInt32(0, "width in bytes per cycle (0: a flit per cycle)")
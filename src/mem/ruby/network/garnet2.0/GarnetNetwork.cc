@@ -30,19 +30,28 @@
 
 #include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
 
+#include <algorithm>
 #include <cassert>
 
 #include "base/cast.hh"
 #include "base/stl_helpers.hh"
+#include "config/have_protobuf.hh"
 #include "mem/ruby/common/NetDest.hh"
 #include "mem/ruby/network/MessageBuffer.hh"
 #include "mem/ruby/network/garnet2.0/CreditLink.hh"
+#include "mem/ruby/network/garnet2.0/DeflectionRouter.hh"
 #include "mem/ruby/network/garnet2.0/GarnetLink.hh"
+#include "mem/ruby/network/garnet2.0/NetworkHeatmap.hh"
 #include "mem/ruby/network/garnet2.0/NetworkInterface.hh"
 #include "mem/ruby/network/garnet2.0/NetworkLink.hh"
 #include "mem/ruby/network/garnet2.0/Router.hh"
+#include "mem/ruby/slicc_interface/AbstractController.hh"
 #include "mem/ruby/system/RubySystem.hh"
 
+#if HAVE_PROTOBUF
+#include "mem/ruby/network/garnet2.0/TraceInjector.hh"
+#endif
+
 using namespace std;
 using m5::stl_helpers::deletePointers;
 
@@ -56,13 +65,30 @@ GarnetNetwork::GarnetNetwork(const Params *p)
     m_buffers_per_data_vc = p->buffers_per_data_vc;
     m_buffers_per_ctrl_vc = p->buffers_per_ctrl_vc;
     m_routing_algorithm = p->routing_algorithm;
+    m_ecmp_seed = p->ecmp_seed;
+    m_sw_allocator = p->sw_allocator;
+    m_sw_alloc_iterations = p->sw_alloc_iterations;
+    m_packet_chaining = p->packet_chaining;
+    m_multicast = p->multicast;
 
     m_enable_fault_model = p->enable_fault_model;
     if (m_enable_fault_model)
         fault_model = p->fault_model;
 
+    m_trace_file = p->trace_file;
+    m_trace_window = p->trace_window;
+    m_trace_ni_queue = p->trace_ni_queue;
+    m_trace_injector = nullptr;
+    m_heatmap_file = p->heatmap_file;
+    m_heatmap_period = p->heatmap_period;
+    m_heatmap = nullptr;
+
     m_vnet_type.resize(m_virtual_networks);
 
+    m_packet_latency_hist.resize(m_virtual_networks);
+    m_pair_packets.resize(m_nodes * m_nodes, 0);
+    m_pair_latency.resize(m_nodes * m_nodes, 0);
+
     for(int i = 0 ; i < m_virtual_networks ; i++)
     {
         if (m_vnet_type_names[i] == "response")
@@ -81,6 +107,19 @@ GarnetNetwork::GarnetNetwork(const Params *p)
         router->init_net_ptr(this);
     }
 
+    // The NIs and stats depend on whether the routers buffer flits, so
+    // all routers must be of the same kind
+    int num_deflection_routers = 0;
+    for (int i = 0; i < m_routers.size(); i++) {
+        if (dynamic_cast<DeflectionRouter *>(m_routers[i]))
+            num_deflection_routers++;
+    }
+    fatal_if(num_deflection_routers > 0 &&
+             num_deflection_routers < m_routers.size(),
+             "Garnet networks cannot mix deflection and VC routers\n");
+    m_bufferless = !m_routers.empty() &&
+        num_deflection_routers == m_routers.size();
+
     // record the network interfaces
     for (vector<ClockedObject*>::const_iterator i = p->netifs.begin();
          i != p->netifs.end(); ++i) {
@@ -99,11 +138,66 @@ GarnetNetwork::init()
         m_nis[i]->addNode(m_toNetQueues[i], m_fromNetQueues[i]);
     }
 
+    // The links are declared to the heatmap as they are created
+    if (!m_heatmap_file.empty()) {
+        m_heatmap = new NetworkHeatmap(this, m_heatmap_file,
+                                       m_heatmap_period);
+        for (int i = 0; i < m_routers.size(); i++)
+            m_heatmap->addRouter(m_routers[i]);
+    }
+
+    // A deflection router has no buffer to hold a packet while it is
+    // copied, and the adaptive routes of the destinations of a packet
+    // may not form a tree
+    fatal_if(m_multicast && m_bufferless,
+             "Deflection routers cannot fork multicast packets\n");
+    fatal_if(m_multicast && m_routing_algorithm == ADAPTIVE_,
+             "Multicast packets cannot be routed adaptively\n");
+
+    bool partitioned = false;
+    for (int i = 0; i < m_routers.size(); i++) {
+        if (m_routers[i]->eventQueue() != m_routers[0]->eventQueue())
+            partitioned = true;
+    }
+
+    // The flits of a branch of a forked packet share a message, whose
+    // reference count is not atomic. The router that copies the flits
+    // and the NI that frees them must be in the same thread.
+    fatal_if(m_multicast && partitioned,
+             "Multicast packets cannot cross network partitions\n");
+
+    // A periodic snapshot reads the counters of every router from the
+    // event queue of the network, while the other partitions run on.
+    // Stats dumps stop all the threads, so those snapshots are safe.
+    fatal_if(m_heatmap != nullptr && m_heatmap_period > 0 && partitioned,
+             "Periodic heatmap snapshots need an unpartitioned network; "
+             "set heatmap_period to 0\n");
+
+    // Randomized message buffers draw their delays from the global
+    // random_mt, which the NIs of several partitions would share
+    fatal_if(RubySystem::getRandomization() && partitioned,
+             "Randomized message buffers cannot be used with network "
+             "partitions\n");
+
+    // Deflected packets overtake each other
+    for (int vnet = 0; vnet < m_virtual_networks; vnet++) {
+        fatal_if(m_bufferless && isVNetOrdered(vnet),
+                 "Deflection routers cannot keep vnet %d ordered\n", vnet);
+    }
+
     // The topology pointer should have already been initialized in the
     // parent network constructor
     assert(m_topology_ptr != NULL);
     m_topology_ptr->createLinks(this);
 
+    // A deflection router sends every flit on in the cycle after it
+    // arrives, which a link slower than a flit per cycle cannot take
+    for (int i = 0; i < m_networklinks.size(); i++) {
+        fatal_if(m_bufferless && m_networklinks[i]->getSerialization() > 1,
+                 "Deflection routers need links as wide as a flit, and "
+                 "link %d is narrower\n", m_networklinks[i]->get_id());
+    }
+
     // Initialize topology specific parameters
     if (getNumRows() > 0)
     {
@@ -134,6 +228,30 @@ GarnetNetwork::init()
             router->printFaultVector(cout);
         }
     }
+
+    if (!m_trace_file.empty()) {
+#if HAVE_PROTOBUF
+        m_trace_injector = new TraceInjector(this, m_trace_file,
+                                             m_trace_window,
+                                             m_trace_ni_queue);
+#else
+        fatal("Replaying network traces requires protobuf support\n");
+#endif
+    }
+}
+
+void
+GarnetNetwork::startup()
+{
+    Network::startup();
+
+#if HAVE_PROTOBUF
+    if (m_trace_injector != nullptr)
+        m_trace_injector->start();
+#endif
+
+    if (m_heatmap != nullptr)
+        m_heatmap->start();
 }
 
 GarnetNetwork::~GarnetNetwork()
@@ -142,6 +260,10 @@ GarnetNetwork::~GarnetNetwork()
     deletePointers(m_nis);
     deletePointers(m_networklinks);
     deletePointers(m_creditlinks);
+    delete m_heatmap;
+#if HAVE_PROTOBUF
+    delete m_trace_injector;
+#endif
 }
 
 /*
@@ -165,9 +287,23 @@ GarnetNetwork::makeInLink(NodeID src, SwitchID dest, BasicLink* link,
     m_networklinks.push_back(net_link);
     m_creditlinks.push_back(credit_link);
 
+    // The NI and its controller share message buffers, so they have to
+    // be in the same event queue
+    AbstractController *cntrl =
+        ((const GarnetExtLinkParams *)garnet_link->params())->ext_node;
+    if (cntrl->eventQueue() != m_nis[src]->eventQueue()) {
+        fatal("NI %d and its controller %s are in different event queues\n",
+              src, cntrl->name());
+    }
+
     PortDirection dest_inport_dirn = L_;
     m_routers[dest]->addInPort(dest_inport_dirn, net_link, credit_link);
     m_nis[src]->addOutPort(net_link, credit_link, dest);
+
+    if (m_heatmap != nullptr) {
+        m_heatmap->addLink(net_link, csprintf("ni-%d", src),
+                           csprintf("router-%d", dest));
+    }
 }
 
 /*
@@ -195,8 +331,13 @@ GarnetNetwork::makeOutLink(SwitchID src, NodeID dest, BasicLink* link,
     PortDirection src_outport_dirn = L_;
     m_routers[src]->addOutPort(src_outport_dirn, net_link,
                                routing_table_entry,
-                               link->m_weight, credit_link);
+                               link->m_weight, credit_link, 0);
     m_nis[dest]->addInPort(net_link, credit_link);
+
+    if (m_heatmap != nullptr) {
+        m_heatmap->addLink(net_link, csprintf("router-%d", src),
+                           csprintf("ni-%d", dest));
+    }
 }
 
 /*
@@ -221,7 +362,18 @@ GarnetNetwork::makeInternalLink(SwitchID src, SwitchID dest,
     m_routers[dest]->addInPort(dest_inport_dirn, net_link, credit_link);
     m_routers[src]->addOutPort(src_outport_dirn, net_link,
                                routing_table_entry,
-                               link->m_weight, credit_link);
+                               link->m_weight, credit_link,
+                               garnet_link->m_bypass_hops);
+
+    if (garnet_link->m_bypass_hops > 0) {
+        ExpressLink express = { net_link, garnet_link->m_bypass_hops, 0 };
+        m_express_links.push_back(express);
+    }
+
+    if (m_heatmap != nullptr) {
+        m_heatmap->addLink(net_link, csprintf("router-%d", src),
+                           csprintf("router-%d", dest));
+    }
 }
 
 int
@@ -236,6 +388,20 @@ GarnetNetwork::get_router_id(int ni)
     return m_nis[ni]->get_router_id();
 }
 
+// The machine of a network node, which is numbered after all the
+// machines of the preceding machine types
+MachineID
+GarnetNetwork::get_machine_id(NodeID ni)
+{
+    for (int m = 0; m < (int) MachineType_NUM; m++) {
+        if (ni < MachineType_base_number((MachineType) (m+1))) {
+            return (MachineID) {(MachineType) m,
+                (ni - MachineType_base_number((MachineType) m))};
+        }
+    }
+    panic("Node %d is not a machine\n", ni);
+}
+
 void
 GarnetNetwork::regStats()
 {
@@ -290,6 +456,71 @@ GarnetNetwork::regStats()
     m_avg_packet_latency.name(name() + ".average_packet_latency");
     m_avg_packet_latency = m_avg_packet_network_latency + m_avg_packet_queueing_latency;
 
+    // Packet latency distributions
+    m_packet_vnet_latency_hist
+        .init(m_virtual_networks, LogHistogram::NumBuckets)
+        .name(name() + ".packet_vnet_latency_hist")
+        .flags(Stats::nozero)
+        ;
+
+    m_packet_vnet_latency_p50
+        .init(m_virtual_networks)
+        .name(name() + ".packet_vnet_latency_p50")
+        .flags(Stats::oneline)
+        ;
+
+    m_packet_vnet_latency_p99
+        .init(m_virtual_networks)
+        .name(name() + ".packet_vnet_latency_p99")
+        .flags(Stats::oneline)
+        ;
+
+    m_packet_vnet_latency_p999
+        .init(m_virtual_networks)
+        .name(name() + ".packet_vnet_latency_p999")
+        .flags(Stats::oneline)
+        ;
+
+    for (int i = 0; i < m_virtual_networks; i++) {
+        m_packet_vnet_latency_hist.subname(i, csprintf("vnet-%i", i));
+        m_packet_vnet_latency_p50.subname(i, csprintf("vnet-%i", i));
+        m_packet_vnet_latency_p99.subname(i, csprintf("vnet-%i", i));
+        m_packet_vnet_latency_p999.subname(i, csprintf("vnet-%i", i));
+    }
+
+    for (int b = 0; b < LogHistogram::NumBuckets; b++) {
+        uint64_t low = LogHistogram::bucketLow(b);
+        uint64_t high = LogHistogram::bucketHigh(b);
+        if (low == high)
+            m_packet_vnet_latency_hist.ysubname(b, csprintf("%d", low));
+        else
+            m_packet_vnet_latency_hist.ysubname(b,
+                csprintf("%d-%d", low, high));
+    }
+
+    m_packet_latency_p50.name(name() + ".packet_latency_p50");
+    m_packet_latency_p99.name(name() + ".packet_latency_p99");
+    m_packet_latency_p999.name(name() + ".packet_latency_p999");
+
+    m_pair_packets_received
+        .init(m_nodes, m_nodes)
+        .name(name() + ".pair_packets_received")
+        .flags(Stats::nozero)
+        ;
+
+    m_pair_avg_packet_latency
+        .init(m_nodes, m_nodes)
+        .name(name() + ".pair_average_packet_latency")
+        .flags(Stats::nozero)
+        ;
+
+    for (int i = 0; i < m_nodes; i++) {
+        m_pair_packets_received.subname(i, csprintf("ni-%i", i));
+        m_pair_packets_received.ysubname(i, csprintf("ni-%i", i));
+        m_pair_avg_packet_latency.subname(i, csprintf("ni-%i", i));
+        m_pair_avg_packet_latency.ysubname(i, csprintf("ni-%i", i));
+    }
+
     // Flits
     m_flits_received
         .init(m_virtual_networks)
@@ -354,6 +585,54 @@ GarnetNetwork::regStats()
         .name(name() + ".avg_vc_load")
         .flags(Stats::pdf | Stats::total | Stats::nozero | Stats::oneline)
         ;
+
+    // Express links
+    if (!m_express_links.empty()) {
+        m_express_flits.name(name() + ".express_flits");
+        m_routers_bypassed.name(name() + ".routers_bypassed");
+        m_bypass_rate
+            .name(name() + ".bypass_rate")
+            .desc("fraction of the routers on the flit paths bypassed "
+                  "by express links")
+            ;
+        m_bypass_rate = m_routers_bypassed /
+            (m_routers_bypassed + m_total_hops);
+    }
+
+    // Deflections
+    if (m_bufferless) {
+        m_flits_routed.name(name() + ".flits_routed");
+        m_flits_deflected.name(name() + ".flits_deflected");
+        m_deflection_rate
+            .name(name() + ".deflection_rate")
+            .desc("fraction of the flits routed away from a minimal path")
+            ;
+        m_deflection_rate = m_flits_deflected / m_flits_routed;
+    }
+
+    // Multicast
+    if (m_multicast) {
+        m_multicast_packets_injected
+            .name(name() + ".multicast_packets_injected");
+        m_multicast_flits_saved
+            .name(name() + ".multicast_flits_saved")
+            .desc("flits that the multicast packets spared the NIs from "
+                  "injecting as one unicast packet per destination")
+            ;
+        m_multicast_flits_replicated
+            .name(name() + ".multicast_flits_replicated")
+            .desc("flits copied by the routers where multicast packets "
+                  "fork")
+            ;
+        m_multicast_packets_received
+            .name(name() + ".multicast_packets_received");
+        m_multicast_packet_latency
+            .name(name() + ".multicast_packet_latency");
+        m_avg_multicast_packet_latency
+            .name(name() + ".average_multicast_packet_latency");
+        m_avg_multicast_packet_latency =
+            m_multicast_packet_latency / m_multicast_packets_received;
+    }
 }
 
 void
@@ -376,6 +655,85 @@ GarnetNetwork::collateStats()
     for (int i = 0; i < m_routers.size(); i++) {
         m_routers[i]->collateStats();
     }
+
+    double express_flits = 0;
+    double routers_bypassed = 0;
+    for (int i = 0; i < m_express_links.size(); i++) {
+        const ExpressLink &express = m_express_links[i];
+        double flits = express.link->getLinkUtilization() -
+            express.base_utilization;
+        express_flits += flits;
+        routers_bypassed += flits * express.bypass_hops;
+    }
+    m_express_flits = express_flits;
+    m_routers_bypassed = routers_bypassed;
+
+    if (m_bufferless) {
+        double flits_routed = 0;
+        double flits_deflected = 0;
+        for (int i = 0; i < m_routers.size(); i++) {
+            DeflectionRouter *router =
+                static_cast<DeflectionRouter *>(m_routers[i]);
+            flits_routed += router->get_flits_routed();
+            flits_deflected += router->get_flits_deflected();
+        }
+        m_flits_routed = flits_routed;
+        m_flits_deflected = flits_deflected;
+    }
+
+    if (m_multicast) {
+        double flits_replicated = 0;
+        for (int i = 0; i < m_routers.size(); i++)
+            flits_replicated += m_routers[i]->get_replicated_flits();
+        m_multicast_flits_replicated = flits_replicated;
+    }
+
+    if (m_heatmap != nullptr)
+        m_heatmap->snapshot();
+
+    // Latency distributions and their percentiles
+    LogHistogram all_vnets;
+    for (int v = 0; v < m_virtual_networks; v++) {
+        const LogHistogram &hist = m_packet_latency_hist[v];
+        for (int b = 0; b < LogHistogram::NumBuckets; b++)
+            m_packet_vnet_latency_hist[v][b] = hist.count(b);
+
+        m_packet_vnet_latency_p50[v] = hist.percentile(0.5);
+        m_packet_vnet_latency_p99[v] = hist.percentile(0.99);
+        m_packet_vnet_latency_p999[v] = hist.percentile(0.999);
+        all_vnets.add(hist);
+    }
+    m_packet_latency_p50 = all_vnets.percentile(0.5);
+    m_packet_latency_p99 = all_vnets.percentile(0.99);
+    m_packet_latency_p999 = all_vnets.percentile(0.999);
+
+    for (int src = 0; src < m_nodes; src++) {
+        for (int dest = 0; dest < m_nodes; dest++) {
+            int pair = src * m_nodes + dest;
+            m_pair_packets_received[src][dest] = m_pair_packets[pair];
+            if (m_pair_packets[pair] > 0) {
+                m_pair_avg_packet_latency[src][dest] =
+                    (double) m_pair_latency[pair] / m_pair_packets[pair];
+            }
+        }
+    }
+}
+
+void
+GarnetNetwork::resetStats()
+{
+    Network::resetStats();
+
+    for (int v = 0; v < m_virtual_networks; v++)
+        m_packet_latency_hist[v].reset();
+    fill(m_pair_packets.begin(), m_pair_packets.end(), 0);
+    fill(m_pair_latency.begin(), m_pair_latency.end(), 0);
+
+    // Link counters are not reset
+    for (int i = 0; i < m_express_links.size(); i++) {
+        m_express_links[i].base_utilization =
+            m_express_links[i].link->getLinkUtilization();
+    }
 }
 
 void
@@ -33,8 +33,12 @@
 #define __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_GARNETNETWORK_D_HH__
 
 #include <iostream>
+#include <mutex>
+#include <string>
 #include <vector>
 
+#include "enums/GarnetSwitchAllocator.hh"
+#include "mem/ruby/common/LogHistogram.hh"
 #include "mem/ruby/network/Network.hh"
 #include "mem/ruby/network/fault_model/FaultModel.hh"
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
@@ -46,6 +50,8 @@ class Router;
 class NetDest;
 class NetworkLink;
 class CreditLink;
+class TraceInjector;
+class NetworkHeatmap;
 
 class GarnetNetwork : public Network
 {
@@ -55,6 +61,7 @@ class GarnetNetwork : public Network
 
     ~GarnetNetwork();
     void init();
+    void startup();
 
     // Configuration (set externally)
 
@@ -65,10 +72,20 @@ class GarnetNetwork : public Network
     // for network
     uint32_t getNiFlitSize() const { return m_ni_flit_size; }
     uint32_t getNumPipeStages() const { return m_num_pipe_stages; }
+    bool isBufferless() const { return m_bufferless; }
     uint32_t getVCsPerVnet() const { return m_vcs_per_vnet; }
     uint32_t getBuffersPerDataVC() { return m_buffers_per_data_vc; }
     uint32_t getBuffersPerCtrlVC() { return m_buffers_per_ctrl_vc; }
     int getRoutingAlgorithm() const { return m_routing_algorithm; }
+    uint32_t getECMPSeed() const { return m_ecmp_seed; }
+    Enums::GarnetSwitchAllocator
+    getSwitchAllocator() const
+    {
+        return m_sw_allocator;
+    }
+    uint32_t getSwAllocIterations() const { return m_sw_alloc_iterations; }
+    bool isPacketChaining() const { return m_packet_chaining; }
+    bool isMulticast() const { return m_multicast; }
 
     bool isFaultModelEnabled() const { return m_enable_fault_model; }
     FaultModel* fault_model;
@@ -84,6 +101,10 @@ class GarnetNetwork : public Network
     }
     int getNumRouters();
     int get_router_id(int ni);
+    static MachineID get_machine_id(NodeID ni);
+    NetworkInterface *get_ni(int ni) { return m_nis[ni]; }
+
+    bool isReplayingTrace() const { return m_trace_injector != nullptr; }
 
 
     // Methods used by Topology to setup the network
@@ -107,8 +128,19 @@ class GarnetNetwork : public Network
     // Stats
     void collateStats();
     void regStats();
+    void resetStats();
     void print(std::ostream& out) const;
 
+    // The NIs of a network partitioned across event queues update the
+    // counters below from several threads, and must hold this lock
+    std::unique_lock<std::mutex>
+    lockStats()
+    {
+        if (inParallelMode)
+            return std::unique_lock<std::mutex>(m_stats_mutex);
+        return std::unique_lock<std::mutex>();
+    }
+
     // increment counters
     void increment_injected_packets(int vnet) { m_packets_injected[vnet]++; }
     void increment_received_packets(int vnet) { m_packets_received[vnet]++; }
@@ -140,6 +172,32 @@ class GarnetNetwork : public Network
         m_flit_queueing_latency[vnet] += latency;
     }
 
+    // Latency of a packet from its injection to its ejection, both in
+    // its vnet's distribution and for its (source, destination) pair
+    void
+    sample_packet_latency(int src_ni, int dest_ni, int vnet, Cycles latency)
+    {
+        m_packet_latency_hist[vnet].sample(latency);
+        int pair = src_ni * m_nodes + dest_ni;
+        m_pair_packets[pair]++;
+        m_pair_latency[pair] += latency;
+    }
+
+    // A multicast packet replaces one unicast packet per destination
+    void
+    increment_multicast_injected(int num_dests, int num_flits)
+    {
+        m_multicast_packets_injected++;
+        m_multicast_flits_saved += (num_dests - 1) * num_flits;
+    }
+
+    void
+    increment_multicast_received(Cycles latency)
+    {
+        m_multicast_packets_received++;
+        m_multicast_packet_latency += latency;
+    }
+
     void
     increment_total_hops(int hops)
     {
@@ -152,11 +210,22 @@ class GarnetNetwork : public Network
     int m_num_cols;
     uint32_t m_ni_flit_size;
     uint32_t m_num_pipe_stages;
+    bool m_bufferless;
     uint32_t m_vcs_per_vnet;
     uint32_t m_buffers_per_ctrl_vc;
     uint32_t m_buffers_per_data_vc;
     int m_routing_algorithm;
+    uint32_t m_ecmp_seed;
+    Enums::GarnetSwitchAllocator m_sw_allocator;
+    uint32_t m_sw_alloc_iterations;
+    bool m_packet_chaining;
+    bool m_multicast;
     bool m_enable_fault_model;
+    std::string m_trace_file;
+    uint32_t m_trace_window;
+    uint32_t m_trace_ni_queue;
+    std::string m_heatmap_file;
+    Cycles m_heatmap_period;
 
     // Statistical variables
     Stats::Vector m_packets_received;
@@ -170,6 +239,18 @@ class GarnetNetwork : public Network
     Stats::Formula m_avg_packet_queueing_latency;
     Stats::Formula m_avg_packet_latency;
 
+    // Latency distributions, copied out of the histograms below by
+    // collateStats()
+    Stats::Vector2d m_packet_vnet_latency_hist;
+    Stats::Vector m_packet_vnet_latency_p50;
+    Stats::Vector m_packet_vnet_latency_p99;
+    Stats::Vector m_packet_vnet_latency_p999;
+    Stats::Scalar m_packet_latency_p50;
+    Stats::Scalar m_packet_latency_p99;
+    Stats::Scalar m_packet_latency_p999;
+    Stats::Vector2d m_pair_packets_received;
+    Stats::Vector2d m_pair_avg_packet_latency;
+
     Stats::Vector m_flits_received;
     Stats::Vector m_flits_injected;
     Stats::Vector m_flit_network_latency;
@@ -187,15 +268,51 @@ class GarnetNetwork : public Network
     Stats::Scalar  m_total_hops;
     Stats::Formula m_avg_hops;
 
+    // Networks with express links only
+    Stats::Scalar  m_express_flits;
+    Stats::Scalar  m_routers_bypassed;
+    Stats::Formula m_bypass_rate;
+
+    // Deflection routers only
+    Stats::Scalar  m_flits_routed;
+    Stats::Scalar  m_flits_deflected;
+    Stats::Formula m_deflection_rate;
+
+    // Multicast networks only
+    Stats::Scalar  m_multicast_packets_injected;
+    Stats::Scalar  m_multicast_flits_saved;
+    Stats::Scalar  m_multicast_flits_replicated;
+    Stats::Scalar  m_multicast_packets_received;
+    Stats::Scalar  m_multicast_packet_latency;
+    Stats::Formula m_avg_multicast_packet_latency;
+
   private:
     GarnetNetwork(const GarnetNetwork& obj);
     GarnetNetwork& operator=(const GarnetNetwork& obj);
 
+    std::mutex m_stats_mutex;
+
+    std::vector<LogHistogram> m_packet_latency_hist; // per vnet
+    // per (source, destination) NI pair, indexed by src * m_nodes + dest
+    std::vector<uint64_t> m_pair_packets;
+    std::vector<uint64_t> m_pair_latency;
+
     std::vector<VNET_type > m_vnet_type;
     std::vector<Router *> m_routers;   // All Routers in Network
     std::vector<NetworkLink *> m_networklinks; // All network (flit) links in the network
     std::vector<CreditLink *> m_creditlinks; // All credit links in the network
     std::vector<NetworkInterface *> m_nis;   // All NI's in Network
+    TraceInjector *m_trace_injector;
+    NetworkHeatmap *m_heatmap;
+
+    struct ExpressLink
+    {
+        NetworkLink *link;
+        int bypass_hops;
+        // Flits at the last stats reset
+        unsigned int base_utilization;
+    };
+    std::vector<ExpressLink> m_express_links;
 };
 
 inline std::ostream&
@@ -34,19 +34,42 @@ from Network import RubyNetwork
 from BasicRouter import BasicRouter
 from ClockedObject import ClockedObject
 
+class GarnetSwitchAllocator(Enum): vals = ['separable', 'islip']
+
 class GarnetNetwork(RubyNetwork):
     type = 'GarnetNetwork'
     cxx_header = "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
     num_rows = Param.Int(0, "number of rows if 2D (mesh/torus/..) topology");
     ni_flit_size = Param.UInt32(16, "network interface flit size in bytes")
+    serdes_latency = Param.Cycles(1, "latency of the serializer, and of the "
+        "deserializer, at the ends of a link narrower than a flit")
     num_pipe_stages = Param.UInt32(5, "number of pipeline stages in the router");
     vcs_per_vnet = Param.UInt32(4, "virtual channels per virtual network");
     buffers_per_data_vc = Param.UInt32(4, "buffers per data virtual channel");
     buffers_per_ctrl_vc = Param.UInt32(1, "buffers per ctrl virtual channel");
     routing_algorithm = Param.Int(1,
-        "0: Weight-based Table, 1: XY, 2: Random, 3: TurnModel");
+        "0: Weight-based Table, 1: XY, 2: Random, 3: TurnModel, 4: ECMP, "
+        "5: Adaptive");
+    ecmp_seed = Param.UInt32(0, "seed of the ECMP flow hash");
+    sw_allocator = Param.GarnetSwitchAllocator('separable', "switch "
+        "allocator: separable input-first round robin, or iSLIP")
+    sw_alloc_iterations = Param.UInt32(1, "iterations of the iSLIP allocator")
+    packet_chaining = Param.Bool(False, "keep the switch connection granted "
+        "to the head flit of a packet for its other flits")
+    multicast = Param.Bool(False, "send a message to all its destinations "
+        "as one packet, forked where the paths to them diverge")
     enable_fault_model = Param.Bool(False, "enable network fault model");
     fault_model = Param.FaultModel(NULL, "network fault model");
+    trace_file = Param.String("", "network packet trace to replay "
+        "(see proto/netpacket.proto)");
+    trace_window = Param.UInt32(4096, "number of trace packets read ahead");
+    trace_ni_queue = Param.UInt32(16, "trace packets an NI holds per vnet "
+        "before the replay waits for it");
+    heatmap_file = Param.String("", "CSV file, in the output directory, "
+        "of per-link and per-router activity");
+    heatmap_period = Param.Cycles(0, "cycles between heatmap snapshots, "
+        "besides those at stats dumps (0: only at stats dumps). Not "
+        "supported with network partitions");
 
 class GarnetNetworkInterface(ClockedObject):
     type = 'GarnetNetworkInterface'
@@ -67,3 +90,9 @@ class GarnetRouter(BasicRouter):
                               "virtual channels per virtual network")
     virt_nets = Param.UInt32(Parent.number_of_virtual_networks,
                           "number of virtual networks")
+
+# Bufferless router that deflects the flits it cannot route productively
+class GarnetDeflectionRouter(GarnetRouter):
+    type = 'GarnetDeflectionRouter'
+    cxx_class = 'DeflectionRouter'
+    cxx_header = "mem/ruby/network/garnet2.0/DeflectionRouter.hh"
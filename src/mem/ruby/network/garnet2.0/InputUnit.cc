@@ -84,13 +84,19 @@ InputUnit::wakeup()
             assert(m_vcs[vc]->get_state() == IDLE_);
             set_vc_active(vc, m_router->curCycle());
 
-            // Route computation for this vc
-            int outport = m_router->route_compute(t_flit->get_route(), m_id, m_direction);
-
-            // Update output port in VC
-            // All flits in this packet will use this output port
-            // The output port field in the flit is updated after it wins SA
-            grant_outport(vc, outport);
+            RouteInfo route = t_flit->get_route();
+            if (route.multicast && route.net_dest.count() > 1) {
+                fork_packet(vc, t_flit);
+            } else {
+                // Route computation for this vc
+                int outport = m_router->route_compute(route, m_id, m_direction);
+
+                // Update output port in VC
+                // All flits in this packet will use this output port
+                // The output port field in the flit is updated after it
+                // wins SA
+                grant_outport(vc, outport);
+            }
 
         } else {
             assert(m_vcs[vc]->get_state() == ACTIVE_);	//[ICN Project] For implementing dropping of packets
@@ -111,9 +117,42 @@ InputUnit::wakeup()
         // performing Switch Allocation
         Cycles wait_time = m_pipeline_delay - Cycles(1);
         t_flit->advance_stage(SA_, m_router->curCycle() + wait_time);
+
+        // Nothing else may wake the router up in time for SA
+        if (wait_time > Cycles(0))
+            m_router->schedule_wakeup(wait_time);
     }
 }
 
+// Route a multicast packet to all of its destinations. If they are all
+// down the same outport, the packet goes on as it is. Otherwise, the VC
+// sends it down one branch per outport, each carrying the destinations
+// of the branch.
+void
+InputUnit::fork_packet(int vc, flit *t_flit)
+{
+    RouteInfo route = t_flit->get_route();
+    vector<pair<int, NetDest> > branches;
+    m_router->multicast_route_compute(route, m_id, m_direction, branches);
+
+    if (branches.size() == 1) {
+        grant_outport(vc, branches[0].first);
+        return;
+    }
+
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+    for (int i = 0; i < branches.size(); i++) {
+        RouteInfo branch_route = route;
+        branch_route.net_dest = branches[i].second;
+        NodeID dest_ni = branch_route.net_dest.getAllDest()[0];
+        branch_route.dest_ni = dest_ni;
+        branch_route.dest_router = net_ptr->get_router_id(dest_ni);
+
+        MsgPtr msg = t_flit->get_msg_ptr()->clone();
+        msg->getDestination() = branch_route.net_dest;
+        m_vcs[vc]->add_branch(branches[i].first, branch_route, msg);
+    }
+}
 
 uint32_t
 InputUnit::functionalWrite(Packet *pkt)
@@ -77,6 +77,42 @@ class InputUnit : public Consumer
         m_vcs[vc]->set_outvc(outvc);
     }
 
+    inline bool
+    is_multicast(int invc)
+    {
+        return m_vcs[invc]->is_multicast();
+    }
+
+    inline int
+    get_num_branches(int invc)
+    {
+        return m_vcs[invc]->get_num_branches();
+    }
+
+    inline int
+    get_branch_outport(int invc, int branch)
+    {
+        return m_vcs[invc]->get_branch_outport(branch);
+    }
+
+    inline void
+    grant_branch_outvcs(int invc, const std::vector<int> &outvcs)
+    {
+        m_vcs[invc]->set_branch_outvcs(outvcs);
+    }
+
+    inline bool
+    is_last_branch(int invc)
+    {
+        return m_vcs[invc]->is_last_branch();
+    }
+
+    inline void
+    next_branch(int invc)
+    {
+        m_vcs[invc]->next_branch();
+    }
+
     inline int
     get_outport(int invc)
     {
@@ -135,6 +171,7 @@ class InputUnit : public Consumer
         m_in_link = link;
     }
 
+    inline NetworkLink *get_in_link() { return m_in_link; }
     inline int get_inlink_id() { return m_in_link->get_id(); }
 
     inline void
@@ -152,6 +189,8 @@ class InputUnit : public Consumer
     void resetStats();
 
   private:
+    void fork_packet(int vc, flit *t_flit);
+
     int m_id;
     PortDirection m_direction;
     int m_num_vcs;
@@ -0,0 +1,166 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/ruby/network/garnet2.0/NetworkHeatmap.hh"
+
+#include "base/cprintf.hh"
+#include "base/misc.hh"
+#include "base/output.hh"
+#include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
+#include "mem/ruby/network/garnet2.0/NetworkLink.hh"
+#include "mem/ruby/network/garnet2.0/Router.hh"
+
+using namespace std;
+
+// The increase of an activity counter, which a stats reset may have
+// brought back to zero
+static double
+increase(double now, double before)
+{
+    return now >= before ? now - before : now;
+}
+
+NetworkHeatmap::NetworkHeatmap(GarnetNetwork *net_ptr,
+                               const string &filename, Cycles period)
+    : m_net_ptr(net_ptr), m_out(simout.create(filename)), m_period(period),
+      m_last_snapshot(0), m_event(this)
+{
+    if (!m_out)
+        fatal("Cannot open network heatmap file %s\n", filename);
+
+    *m_out << "start_cycle,end_cycle,element,id,src,dst,metric,value\n";
+}
+
+NetworkHeatmap::~NetworkHeatmap()
+{
+    if (m_event.scheduled())
+        m_net_ptr->deschedule(m_event);
+    simout.close(m_out);
+}
+
+const string
+NetworkHeatmap::name() const
+{
+    return m_net_ptr->name() + ".heatmap";
+}
+
+void
+NetworkHeatmap::addLink(NetworkLink *link, const string &src,
+                        const string &dst)
+{
+    LinkRecord record;
+    record.link = link;
+    record.src = src;
+    record.dst = dst;
+    record.utilization = 0;
+    record.vc_load.resize(link->getVcLoad().size(), 0);
+    m_links.push_back(record);
+}
+
+void
+NetworkHeatmap::addRouter(Router *router)
+{
+    RouterRecord record;
+    record.router = router;
+    record.buffer_reads = 0;
+    record.buffer_writes = 0;
+    record.crossbar_activity = 0;
+    m_routers.push_back(record);
+}
+
+void
+NetworkHeatmap::start()
+{
+    m_last_snapshot = m_net_ptr->curCycle();
+    if (m_period > 0)
+        m_net_ptr->schedule(m_event, m_net_ptr->clockEdge(m_period));
+}
+
+void
+NetworkHeatmap::periodicSnapshot()
+{
+    snapshot();
+    m_net_ptr->schedule(m_event, m_net_ptr->clockEdge(m_period));
+}
+
+void
+NetworkHeatmap::writeRow(const char *element, int id, const string &src,
+                         const string &dst, const string &metric,
+                         double value)
+{
+    ccprintf(*m_out, "%d,%d,%s,%d,%s,%s,%s,%g\n", m_last_snapshot,
+             m_net_ptr->curCycle(), element, id, src, dst, metric, value);
+}
+
+void
+NetworkHeatmap::snapshot()
+{
+    Cycles now = m_net_ptr->curCycle();
+    if (now <= m_last_snapshot)
+        return;
+    double cycles = now - m_last_snapshot;
+
+    for (auto &record : m_links) {
+        // The link counters only grow, and wrap around like the
+        // unsigned differences below
+        NetworkLink *link = record.link;
+        unsigned int utilization = link->getLinkUtilization();
+        writeRow("link", link->get_id(), record.src, record.dst,
+                 "utilization",
+                 (utilization - record.utilization) / cycles);
+        record.utilization = utilization;
+
+        const vector<unsigned int> &vc_load = link->getVcLoad();
+        for (int vc = 0; vc < vc_load.size(); vc++) {
+            unsigned int load = vc_load[vc] - record.vc_load[vc];
+            if (load > 0) {
+                writeRow("link", link->get_id(), record.src, record.dst,
+                         csprintf("vc-%d_load", vc), load / cycles);
+            }
+            record.vc_load[vc] = vc_load[vc];
+        }
+    }
+
+    for (auto &record : m_routers) {
+        Router *router = record.router;
+        double reads = router->get_buffer_reads();
+        double writes = router->get_buffer_writes();
+        double crossbar = router->get_crossbar_activity();
+
+        writeRow("router", router->get_id(), "", "", "buffer_reads",
+                 increase(reads, record.buffer_reads));
+        writeRow("router", router->get_id(), "", "", "buffer_writes",
+                 increase(writes, record.buffer_writes));
+        writeRow("router", router->get_id(), "", "", "crossbar_activity",
+                 increase(crossbar, record.crossbar_activity));
+
+        record.buffer_reads = reads;
+        record.buffer_writes = writes;
+        record.crossbar_activity = crossbar;
+    }
+
+    m_out->flush();
+    m_last_snapshot = now;
+}
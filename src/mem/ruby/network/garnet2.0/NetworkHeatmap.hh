@@ -0,0 +1,109 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_NETWORK_HEATMAP_HH__
+#define __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_NETWORK_HEATMAP_HH__
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "base/types.hh"
+#include "sim/eventq.hh"
+
+class GarnetNetwork;
+class NetworkLink;
+class Router;
+
+/**
+ * Writes the activity of every link and router of a garnet network as
+ * CSV, one row per element and metric:
+ *
+ *   start_cycle,end_cycle,element,id,src,dst,metric,value
+ *
+ * Links are tagged with their topology link id and their endpoints
+ * (router-<id> or ni-<id>); their metrics are the utilization and the
+ * load of each VC used, in flits per cycle. Routers have their buffer
+ * reads and writes and crossbar activity, as counts.
+ *
+ * Each snapshot covers the cycles since the previous one. A snapshot is
+ * taken at every stats dump and, with a non-zero period, every period
+ * cycles, giving a time series of how congestion develops.
+ */
+class NetworkHeatmap
+{
+  public:
+    NetworkHeatmap(GarnetNetwork *net_ptr, const std::string &filename,
+                   Cycles period);
+    ~NetworkHeatmap();
+
+    void addLink(NetworkLink *link, const std::string &src,
+                 const std::string &dst);
+    void addRouter(Router *router);
+
+    // Start the periodic snapshots
+    void start();
+    void snapshot();
+
+    const std::string name() const;
+
+  private:
+    void periodicSnapshot();
+
+    struct LinkRecord
+    {
+        NetworkLink *link;
+        std::string src;
+        std::string dst;
+        // Counts at the last snapshot
+        unsigned int utilization;
+        std::vector<unsigned int> vc_load;
+    };
+
+    struct RouterRecord
+    {
+        Router *router;
+        // Counts at the last snapshot
+        double buffer_reads;
+        double buffer_writes;
+        double crossbar_activity;
+    };
+
+    void writeRow(const char *element, int id, const std::string &src,
+                  const std::string &dst, const std::string &metric,
+                  double value);
+
+    GarnetNetwork *m_net_ptr;
+    std::ostream *m_out;
+    Cycles m_period;
+    Cycles m_last_snapshot;
+
+    std::vector<LinkRecord> m_links;
+    std::vector<RouterRecord> m_routers;
+
+    EventWrapper<NetworkHeatmap, &NetworkHeatmap::periodicSnapshot> m_event;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_NETWORK_HEATMAP_HH__
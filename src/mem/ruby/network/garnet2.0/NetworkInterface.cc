@@ -38,6 +38,7 @@
 #include "base/stl_helpers.hh"
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/network/MessageBuffer.hh"
+#include "mem/ruby/network/garnet2.0/TraceMessage.hh"
 #include "mem/ruby/network/garnet2.0/flitBuffer.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
 
@@ -65,6 +66,7 @@ NetworkInterface::NetworkInterface(const Params *p)
     for (int i = 0; i < m_virtual_networks; i++) {
         m_vc_allocator[i] = 0;
     }
+    m_trace_queue.resize(m_virtual_networks);
 }
 
 void
@@ -122,6 +124,15 @@ NetworkInterface::addNode(vector<MessageBuffer *>& in,
     }
 }
 
+// A trace packet injected by the network's TraceInjector, which waits
+// here for a VC in the same way as a protocol message would in inNode_ptr
+void
+NetworkInterface::enqueueTracePacket(MsgPtr msg_ptr, int vnet)
+{
+    m_trace_queue[vnet].push_back(msg_ptr);
+    scheduleEventAbsolute(clockEdge());
+}
+
 
 /*
  * The NI wakeup checks whether there are any ready messages in the protocol
@@ -151,7 +162,9 @@ NetworkInterface::wakeup()
 
         if (b->isReady(curTime)) { // Is there a message waiting
             msg_ptr = b->peekMsgPtr();
-            if (flitisizeMessage(msg_ptr, vnet)) {
+            int size = m_net_ptr->MessageSizeType_to_int(
+                msg_ptr->getMessageSize());
+            if (flitisizeMessage(msg_ptr, vnet, size)) {
                 b->dequeue(curTime);
             } else {
                 break;
@@ -159,8 +172,18 @@ NetworkInterface::wakeup()
         }
     }
 
+    // Trace packets, which carry their own size
+    for (int vnet = 0; vnet < m_trace_queue.size(); ++vnet) {
+        deque<MsgPtr> &q = m_trace_queue[vnet];
+        if (!q.empty()) {
+            int size = static_cast<TraceMessage *>(q.front().get())->getSize();
+            if (flitisizeMessage(q.front(), vnet, size)) {
+                q.pop_front();
+            }
+        }
+    }
+
     scheduleOutputLink();
-    checkReschedule();
 
     /*********** Picking messages destined for this NI **********/
 
@@ -169,10 +192,17 @@ NetworkInterface::wakeup()
         bool free_signal = false;
         if (t_flit->get_type() == TAIL_ || t_flit->get_type() == HEAD_TAIL_) {
             free_signal = true;
+        }
 
-            // enqueue into the protocol buffers
-            outNode_ptr[t_flit->get_vnet()]->enqueue(
-                t_flit->get_msg_ptr(), curTime, cyclesToTicks(Cycles(1)));
+        bool packet_done = reassemble(t_flit);
+        if (packet_done) {
+            // enqueue into the protocol buffers, unless this is a trace
+            // packet, which ends here
+            if (!m_net_ptr->isReplayingTrace() ||
+                !dynamic_cast<TraceMessage *>(t_flit->get_msg_ptr().get())) {
+                outNode_ptr[t_flit->get_vnet()]->enqueue(
+                    t_flit->get_msg_ptr(), curTime, cyclesToTicks(Cycles(1)));
+            }
         }
         // Simply send a credit back since we are not buffering
         // this flit in the NI
@@ -185,6 +215,7 @@ NetworkInterface::wakeup()
         int vnet = t_flit->get_vnet();
 
         // Update Stats
+        auto stats_lock = m_net_ptr->lockStats();
 
         // Latency
         m_net_ptr->increment_received_flits(vnet);
@@ -194,10 +225,16 @@ NetworkInterface::wakeup()
         m_net_ptr->increment_flit_network_latency(network_delay, vnet);
         m_net_ptr->increment_flit_queueing_latency(queueing_delay, vnet);
 
-        if (t_flit->get_type() == TAIL_ || t_flit->get_type() == HEAD_TAIL_) {
+        if (packet_done) {
             m_net_ptr->increment_received_packets(vnet);
             m_net_ptr->increment_packet_network_latency(network_delay, vnet);
             m_net_ptr->increment_packet_queueing_latency(queueing_delay, vnet);
+            m_net_ptr->sample_packet_latency(t_flit->get_route().src_ni, m_id,
+                vnet, network_delay + queueing_delay);
+            if (t_flit->get_route().multicast) {
+                m_net_ptr->increment_multicast_received(
+                    network_delay + queueing_delay);
+            }
         }
 
         // Hops
@@ -216,10 +253,34 @@ NetworkInterface::wakeup()
         }
         delete t_flit;
     }
+
+    // Done after the credit update, which may unblock the NI
+    checkReschedule();
 }
 
+// Whether a received flit completes its packet. Behind VC routers, the
+// flits of a packet arrive in order, but behind deflection routers they
+// may take different paths, and the packet is complete once all of them
+// have arrived.
 bool
-NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
+NetworkInterface::reassemble(flit *t_flit)
+{
+    if (!m_net_ptr->isBufferless()) {
+        return t_flit->get_type() == TAIL_ ||
+               t_flit->get_type() == HEAD_TAIL_;
+    }
+
+    const Message *msg = t_flit->get_msg_ptr().get();
+    int received = ++m_flits_reassembled[msg];
+    if (received < t_flit->get_size())
+        return false;
+
+    m_flits_reassembled.erase(msg);
+    return true;
+}
+
+bool
+NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet, int size)
 {
     Message *net_msg_ptr = msg_ptr.get();
     NetDest net_msg_dest = net_msg_ptr->getDestination();
@@ -229,8 +290,10 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
 
     // Number of flits is dependent on the link bandwidth available.
     // This is expressed in terms of bytes/cycle or the flit size
-    int num_flits = (int) ceil((double) m_net_ptr->MessageSizeType_to_int(
-        net_msg_ptr->getMessageSize())/m_net_ptr->getNiFlitSize());
+    int num_flits = (int) ceil((double) size/m_net_ptr->getNiFlitSize());
+
+    if (m_net_ptr->isMulticast() && dest_nodes.size() > 1)
+        return flitisizeMulticast(msg_ptr, vnet, num_flits);
 
     // loop to convert all multicast messages into unicast messages
     for (int ctr = 0; ctr < dest_nodes.size(); ctr++) {
@@ -269,12 +332,17 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
         // NetDest format is used by the routing table
         // Custom routing algorithms just need destID
         RouteInfo route;
+        route.vnet = vnet;
         route.net_dest = new_net_msg_ptr->getDestination();
+        route.src_ni = m_id;
+        route.src_router = m_router_id;
         route.dest_ni = destID;
         route.dest_router = m_net_ptr->get_router_id(destID);
         // initialize hops to -1, so that the first router increments it to 0
         route.hops = -1;
+        route.multicast = false;
 
+        auto stats_lock = m_net_ptr->lockStats();
         m_net_ptr->increment_injected_packets(vnet);
         for (int i = 0; i < num_flits; i++) {
             m_net_ptr->increment_injected_flits(vnet);
@@ -291,6 +359,47 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
     return true ;
 }
 
+// Send a message to all its destinations as a single packet, which the
+// routers fork where the paths to the destinations diverge. The route
+// names the first destination for routing that only takes one.
+bool
+NetworkInterface::flitisizeMulticast(MsgPtr msg_ptr, int vnet, int num_flits)
+{
+    int vc = calculateVC(vnet);
+    if (vc == -1)
+        return false;
+
+    MsgPtr new_msg_ptr = msg_ptr->clone();
+    NetDest net_dest = new_msg_ptr->getDestination();
+    vector<NodeID> dest_nodes = net_dest.getAllDest();
+
+    RouteInfo route;
+    route.vnet = vnet;
+    route.net_dest = net_dest;
+    route.src_ni = m_id;
+    route.src_router = m_router_id;
+    route.dest_ni = dest_nodes[0];
+    route.dest_router = m_net_ptr->get_router_id(dest_nodes[0]);
+    route.hops = -1;
+    route.multicast = true;
+
+    auto stats_lock = m_net_ptr->lockStats();
+    m_net_ptr->increment_injected_packets(vnet);
+    m_net_ptr->increment_multicast_injected(dest_nodes.size(), num_flits);
+    for (int i = 0; i < num_flits; i++) {
+        m_net_ptr->increment_injected_flits(vnet);
+        flit *fl = new flit(i, vc, vnet, route, num_flits, new_msg_ptr,
+            curCycle());
+
+        fl->set_delay(curCycle() - ticksToCycles(msg_ptr->getTime()));
+        m_ni_out_vcs[vc]->insert(fl);
+    }
+
+    m_ni_out_vcs_enqueue_time[vc] = curCycle();
+    m_out_vc_state[vc]->setState(ACTIVE_, curCycle());
+    return true;
+}
+
 // Looking for a free output vc
 int
 NetworkInterface::calculateVC(int vnet)
@@ -382,22 +491,49 @@ NetworkInterface::get_vnet(int vc)
     fatal("Could not determine vc");
 }
 
+bool
+NetworkInterface::has_free_vc(int vnet, Cycles time)
+{
+    for (int vc = vnet*m_vc_per_vnet; vc < (vnet+1)*m_vc_per_vnet; vc++) {
+        if (m_out_vc_state[vc]->isInState(IDLE_, time))
+            return true;
+    }
+    return false;
+}
+
+/** Wake up in the next cycle only if there is work that can make
+ *  progress. Messages waiting for a free VC and flits waiting for a
+ *  credit are woken up by the credit that unblocks them.
+ */
+
 void
 NetworkInterface::checkReschedule()
 {
-    for (const auto& it : inNode_ptr) {
-        if (it == nullptr) {
+    Cycles nextCycle = curCycle() + Cycles(1);
+
+    for (int vnet = 0; vnet < inNode_ptr.size(); ++vnet) {
+        MessageBuffer *b = inNode_ptr[vnet];
+        if (b == nullptr) {
             continue;
         }
 
-        while (it->isReady(clockEdge())) { // Is there a message waiting
+        // Is there a message waiting that can get a VC
+        if (b->isReady(clockEdge()) && has_free_vc(vnet, nextCycle)) {
+            scheduleEvent(Cycles(1));
+            return;
+        }
+    }
+
+    for (int vnet = 0; vnet < m_trace_queue.size(); ++vnet) {
+        if (!m_trace_queue[vnet].empty() && has_free_vc(vnet, nextCycle)) {
             scheduleEvent(Cycles(1));
             return;
         }
     }
 
     for (int vc = 0; vc < m_num_vcs; vc++) {
-        if (m_ni_out_vcs[vc]->isReady(curCycle() + Cycles(1))) {
+        if (m_ni_out_vcs[vc]->isReady(nextCycle) &&
+            m_out_vc_state[vc]->has_credit()) {
             scheduleEvent(Cycles(1));
             return;
         }
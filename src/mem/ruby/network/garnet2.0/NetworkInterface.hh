@@ -32,7 +32,9 @@
 #ifndef __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_NETWORK_INTERFACE_D_HH__
 #define __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_NETWORK_INTERFACE_D_HH__
 
+#include <deque>
 #include <iostream>
+#include <unordered_map>
 #include <vector>
 
 #include "mem/ruby/common/Consumer.hh"
@@ -62,6 +64,9 @@ class NetworkInterface : public ClockedObject, public Consumer
     void wakeup();
     void addNode(std::vector<MessageBuffer *> &inNode,
                  std::vector<MessageBuffer *> &outNode);
+    void enqueueTracePacket(MsgPtr msg_ptr, int vnet);
+    int getNumTracePackets(int vnet) const
+    { return m_trace_queue[vnet].size(); }
 
     void print(std::ostream& out) const;
     int get_vnet(int vc);
@@ -95,11 +100,19 @@ class NetworkInterface : public ClockedObject, public Consumer
     std::vector<MessageBuffer *> inNode_ptr;
     // The Message buffers that provides messages to the protocol
     std::vector<MessageBuffer *> outNode_ptr;
-
-    bool flitisizeMessage(MsgPtr msg_ptr, int vnet);
+    // The trace packets waiting for injection, per vnet
+    std::vector<std::deque<MsgPtr> > m_trace_queue;
+    // Flits received of the packets being reassembled, behind
+    // deflection routers which deliver the flits in any order
+    std::unordered_map<const Message *, int> m_flits_reassembled;
+
+    bool flitisizeMessage(MsgPtr msg_ptr, int vnet, int size);
+    bool flitisizeMulticast(MsgPtr msg_ptr, int vnet, int num_flits);
     int calculateVC(int vnet);
     void scheduleOutputLink();
     void checkReschedule();
+    bool has_free_vc(int vnet, Cycles time);
+    bool reassemble(flit *t_flit);
 };
 
 #endif // __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_NETWORK_INTERFACE_D_HH__
@@ -30,15 +30,35 @@
 
 #include "mem/ruby/network/garnet2.0/NetworkLink.hh"
 
+#include "base/misc.hh"
 #include "mem/ruby/network/garnet2.0/CreditLink.hh"
 
 NetworkLink::NetworkLink(const Params *p)
     : ClockedObject(p), Consumer(this), m_id(p->link_id),
       m_latency(p->link_latency),
       linkBuffer(new flitBuffer()), link_consumer(nullptr),
-      link_srcQueue(nullptr), m_link_utilized(0),
+      link_srcQueue(nullptr), m_remote_consumer(false), m_link_utilized(0),
       m_vc_load(p->vcs_per_vnet * p->virt_nets)
 {
+    m_serialization = 1;
+    m_serdes_delay = Cycles(0);
+    m_free_cycle = Cycles(0);
+
+    if (p->width > 0) {
+        // Flits are the unit of flow control throughout the network, so
+        // a wider link would not carry more of them
+        fatal_if(p->width > p->flit_size, "Link %d is %d bytes wide, wider "
+                 "than a %d-byte flit: make the flits as wide as the "
+                 "widest link\n", m_id, p->width, p->flit_size);
+
+        m_serialization = (p->flit_size + p->width - 1) / p->width;
+        if (m_serialization > 1) {
+            // The tail of a flit arrives m_serialization - 1 cycles
+            // after its head
+            m_serdes_delay = Cycles(2 * p->serdes_latency +
+                                    m_serialization - 1);
+        }
+    }
 }
 
 NetworkLink::~NetworkLink()
@@ -46,6 +66,22 @@ NetworkLink::~NetworkLink()
     delete linkBuffer;
 }
 
+void
+NetworkLink::init()
+{
+    ClockedObject::init();
+
+    m_remote_consumer = link_consumer &&
+        (link_consumer->consumerEventQueue() != eventQueue());
+
+    // The link latency is the lookahead between the event queues
+    if (m_remote_consumer && simQuantum > cyclesToTicks(m_latency)) {
+        fatal("Link %d crosses event queues but its latency (%d ticks) "
+              "is shorter than the simulation quantum (%d ticks)\n",
+              m_id, cyclesToTicks(m_latency), simQuantum);
+    }
+}
+
 void
 NetworkLink::setLinkConsumer(Consumer *consumer)
 {
@@ -61,16 +97,44 @@ NetworkLink::setSourceQueue(flitBuffer *srcQueue)
 void
 NetworkLink::wakeup()
 {
+    // Still serializing the previous flit
+    if (curCycle() < m_free_cycle) {
+        scheduleEvent(m_free_cycle - curCycle());
+        return;
+    }
+
     if (link_srcQueue->isReady(curCycle())) {
         flit *t_flit = link_srcQueue->getTopFlit();
-        t_flit->set_time(curCycle() + m_latency);
-        linkBuffer->insert(t_flit);
-        link_consumer->scheduleEventAbsolute(clockEdge(m_latency));
+        Cycles latency = m_latency + m_serdes_delay;
+        t_flit->set_time(curCycle() + latency);
         m_link_utilized++;
         m_vc_load[t_flit->get_vc()]++;
+
+        if (m_remote_consumer) {
+            link_consumer->consumerEventQueue()->schedule(
+                new DeliveryEvent(this, t_flit), clockEdge(latency));
+        } else {
+            linkBuffer->insert(t_flit);
+            link_consumer->scheduleEventAbsolute(clockEdge(latency));
+        }
+
+        // The flits queued behind it only had a wakeup for this cycle
+        if (m_serialization > 1) {
+            m_free_cycle = curCycle() + Cycles(m_serialization);
+            if (!link_srcQueue->isEmpty())
+                scheduleEvent(Cycles(m_serialization));
+        }
     }
 }
 
+// Runs in the consumer's event queue
+void
+NetworkLink::deliver(flit *t_flit)
+{
+    linkBuffer->insert(t_flit);
+    link_consumer->scheduleEventAbsolute(curTick());
+}
+
 NetworkLink *
 NetworkLinkParams::create()
 {
@@ -49,12 +49,17 @@ class NetworkLink : public ClockedObject, public Consumer
     NetworkLink(const Params *p);
     ~NetworkLink();
 
+    void init();
+
     void setLinkConsumer(Consumer *consumer);
     void setSourceQueue(flitBuffer *srcQueue);
     void print(std::ostream& out) const {}
     int get_id() const { return m_id; }
     void wakeup();
 
+    // Cycles the link takes to send a flit
+    int getSerialization() const { return m_serialization; }
+
     unsigned int getLinkUtilization() const { return m_link_utilized; }
     const std::vector<unsigned int> & getVcLoad() const { return m_vc_load; }
 
@@ -70,10 +75,41 @@ class NetworkLink : public ClockedObject, public Consumer
     const int m_id;
     const Cycles m_latency;
 
+    // A link narrower than a flit has a serializer at its source and a
+    // deserializer at its destination. It sends a flit every
+    // m_serialization cycles, each taking m_serdes_delay cycles on top of
+    // the link latency.
+    int m_serialization;
+    Cycles m_serdes_delay;
+    Cycles m_free_cycle;
+
     flitBuffer *linkBuffer;
     Consumer *link_consumer;
     flitBuffer *link_srcQueue;
 
+    // The link runs in the event queue of its source. When the consumer
+    // is in another one, each flit is handed over by an event in the
+    // consumer's queue, which runs before the consumer wakes up.
+    bool m_remote_consumer;
+
+    class DeliveryEvent : public Event
+    {
+      public:
+        DeliveryEvent(NetworkLink *link, flit *t_flit)
+            : Event(Default_Pri - 1, AutoDelete), m_link(link),
+              m_flit(t_flit)
+        {
+        }
+
+        void process() { m_link->deliver(m_flit); }
+
+      private:
+        NetworkLink *m_link;
+        flit *m_flit;
+    };
+
+    void deliver(flit *t_flit);
+
     // Statistical variables
     unsigned int m_link_utilized;
     std::vector<unsigned int> m_vc_load;
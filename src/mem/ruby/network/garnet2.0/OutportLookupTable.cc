@@ -0,0 +1,88 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/ruby/network/garnet2.0/OutportLookupTable.hh"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+OutportLookupTable::OutportLookupTable()
+    : m_offset(1, 0), m_min_offset(1, 0)
+{
+}
+
+void
+OutportLookupTable::build(const vector<vector<NodeID> > &outport_dests,
+                          const vector<int> &outport_weights, int num_nodes)
+{
+    assert(outport_dests.size() == outport_weights.size());
+
+    // Count the candidates of every destination first so that the
+    // outports can be laid out contiguously in a single pass
+    vector<int> count(num_nodes, 0);
+    for (int outport = 0; outport < outport_dests.size(); outport++) {
+        for (NodeID dest : outport_dests[outport]) {
+            assert(dest < num_nodes);
+            count[dest]++;
+        }
+    }
+
+    m_offset.assign(num_nodes + 1, 0);
+    for (int dest = 0; dest < num_nodes; dest++) {
+        m_offset[dest + 1] = m_offset[dest] + count[dest];
+    }
+
+    m_outport.resize(m_offset[num_nodes]);
+    m_weight.resize(m_offset[num_nodes]);
+
+    // Walking the outports in order keeps each slice sorted by outport
+    vector<int> fill(m_offset.begin(), m_offset.end() - 1);
+    for (int outport = 0; outport < outport_dests.size(); outport++) {
+        for (NodeID dest : outport_dests[outport]) {
+            m_outport[fill[dest]] = outport;
+            m_weight[fill[dest]] = outport_weights[outport];
+            fill[dest]++;
+        }
+    }
+
+    // Extract the smallest-weight candidates of every destination
+    m_min_offset.assign(num_nodes + 1, 0);
+    m_min_outport.clear();
+    for (int dest = 0; dest < num_nodes; dest++) {
+        int begin = m_offset[dest];
+        int end = m_offset[dest + 1];
+        if (begin != end) {
+            int min_weight = *min_element(m_weight.begin() + begin,
+                                          m_weight.begin() + end);
+            for (int i = begin; i < end; i++) {
+                if (m_weight[i] == min_weight)
+                    m_min_outport.push_back(m_outport[i]);
+            }
+        }
+        m_min_offset[dest + 1] = m_min_outport.size();
+    }
+}
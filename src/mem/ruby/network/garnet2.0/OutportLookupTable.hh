@@ -0,0 +1,137 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_OUTPORT_LOOKUP_TABLE_HH__
+#define __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_OUTPORT_LOOKUP_TABLE_HH__
+
+#include <vector>
+
+#include "mem/ruby/common/TypeDefines.hh"
+
+/**
+ * Per-router index from a destination NI to the set of outports whose
+ * routing table entry contains it. The index is built once from the
+ * per-outport destination lists produced by the topology and stored in
+ * a compressed row layout, so that the candidates of a destination are
+ * a single contiguous slice. Candidates are kept in ascending outport
+ * order, which is the order a linear scan of the routing table visits
+ * them in. The subset of candidates that share the smallest link weight
+ * is kept in a second slice for weight-aware multipath routing.
+ */
+class OutportLookupTable
+{
+  public:
+    OutportLookupTable();
+
+    /**
+     * Build the index.
+     * @param outport_dests Destination NIs reachable through each outport.
+     * @param outport_weights Link weight of each outport.
+     * @param num_nodes Total number of NIs in the network.
+     */
+    void build(const std::vector<std::vector<NodeID> > &outport_dests,
+               const std::vector<int> &outport_weights, int num_nodes);
+
+    int getNumNodes() const { return m_offset.size() - 1; }
+
+    int
+    getNumCandidates(NodeID dest) const
+    {
+        return m_offset[dest + 1] - m_offset[dest];
+    }
+
+    int
+    getCandidate(NodeID dest, int idx) const
+    {
+        return m_outport[m_offset[dest] + idx];
+    }
+
+    int
+    getCandidateWeight(NodeID dest, int idx) const
+    {
+        return m_weight[m_offset[dest] + idx];
+    }
+
+    // Lowest-numbered outport with the smallest link weight, or -1
+    int
+    getMinWeightOutport(NodeID dest) const
+    {
+        return getNumMinWeightCandidates(dest) ? getMinWeightCandidate(dest, 0)
+                                               : -1;
+    }
+
+    int
+    getNumMinWeightCandidates(NodeID dest) const
+    {
+        return m_min_offset[dest + 1] - m_min_offset[dest];
+    }
+
+    int
+    getMinWeightCandidate(NodeID dest, int idx) const
+    {
+        return m_min_outport[m_min_offset[dest] + idx];
+    }
+
+    /**
+     * Candidate of adaptive routing: among the candidates of dest that
+     * have an idle VC, the one with the most free credits, scanning
+     * from candidate start so that ties go to the first one visited.
+     * Returns -1 when no candidate has an idle VC.
+     * @param has_free_vc Whether an outport has an idle VC.
+     * @param free_credits Free credits of an outport.
+     */
+    template <typename HasFreeVC, typename FreeCredits>
+    int
+    getAdaptiveCandidate(NodeID dest, int start, HasFreeVC has_free_vc,
+                         FreeCredits free_credits) const
+    {
+        int num_candidates = getNumCandidates(dest);
+        int best_outport = -1;
+        int best_credits = -1;
+        for (int i = 0; i < num_candidates; i++) {
+            int outport = getCandidate(dest, (start + i) % num_candidates);
+            if (!has_free_vc(outport))
+                continue;
+            int credits = free_credits(outport);
+            if (credits > best_credits) {
+                best_outport = outport;
+                best_credits = credits;
+            }
+        }
+        return best_outport;
+    }
+
+  private:
+    // m_offset[d] .. m_offset[d+1] delimits the candidates of NI d
+    std::vector<int> m_offset;
+    std::vector<int> m_outport;
+    std::vector<int> m_weight;
+
+    // Same layout, restricted to the smallest-weight candidates
+    std::vector<int> m_min_offset;
+    std::vector<int> m_min_outport;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_OUTPORT_LOOKUP_TABLE_HH__
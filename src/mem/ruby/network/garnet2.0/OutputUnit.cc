@@ -84,12 +84,16 @@ OutputUnit::has_credit(int out_vc)
 }
 
 
+// The first VC of every vnet is the escape VC of adaptive routing.
+// Packets that are not on their escape route must skip it.
 bool
 OutputUnit::has_free_vc(int vnet,
-    PortDirection inport_dirn, PortDirection outport_dirn)
+    PortDirection inport_dirn, PortDirection outport_dirn,
+    bool use_escape_vc)
 {
     int vc_base = vnet*m_vc_per_vnet;
-    for (int vc = vc_base; vc < vc_base + m_vc_per_vnet; vc++)
+    int vc_first = use_escape_vc ? vc_base : vc_base + 1;
+    for (int vc = vc_first; vc < vc_base + m_vc_per_vnet; vc++)
     {
         if (is_vc_idle(vc, m_router->curCycle()))
             return true;
@@ -100,10 +104,12 @@ OutputUnit::has_free_vc(int vnet,
 
 int
 OutputUnit::select_free_vc(int vnet,
-    PortDirection inport_dirn, PortDirection outport_dirn)
+    PortDirection inport_dirn, PortDirection outport_dirn,
+    bool use_escape_vc)
 {
     int vc_base = vnet*m_vc_per_vnet;
-    for (int vc = vc_base; vc < vc_base + m_vc_per_vnet; vc++)
+    int vc_first = use_escape_vc ? vc_base : vc_base + 1;
+    for (int vc = vc_first; vc < vc_base + m_vc_per_vnet; vc++)
     {
         if (is_vc_idle(vc, m_router->curCycle()))
         {
@@ -115,6 +121,19 @@ OutputUnit::select_free_vc(int vnet,
     return -1;
 }
 
+// Buffers free in the downstream router across all VCs of a vnet
+int
+OutputUnit::get_free_credits(int vnet)
+{
+    int credits = 0;
+    int vc_base = vnet*m_vc_per_vnet;
+    for (int vc = vc_base; vc < vc_base + m_vc_per_vnet; vc++)
+    {
+        credits += m_outvc_state[vc]->get_credit_count();
+    }
+
+    return credits;
+}
 
 void
 OutputUnit::wakeup()
@@ -130,6 +149,15 @@ OutputUnit::wakeup()
     }
 }
 
+// A bufferless router does not track the buffers downstream, and drops
+// the credits sent back to it
+void
+OutputUnit::discard_credits()
+{
+    while (m_credit_link->isReady(m_router->curCycle()))
+        delete m_credit_link->consumeLink();
+}
+
 flitBuffer*
 OutputUnit::getOutQueue()
 {
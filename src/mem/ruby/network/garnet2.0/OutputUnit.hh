@@ -50,15 +50,19 @@ class OutputUnit : public Consumer
     void set_out_link(NetworkLink *link);
     void set_credit_link(CreditLink *credit_link);
     void wakeup();
+    void discard_credits();
     flitBuffer* getOutQueue();
     void print(std::ostream& out) const {};
     void decrement_credit(int out_vc);
     void increment_credit(int out_vc);
     bool has_credit(int out_vc);
     bool has_free_vc(int vnet,
-        PortDirection inport_dirn, PortDirection outport_dirn);
+        PortDirection inport_dirn, PortDirection outport_dirn,
+        bool use_escape_vc = true);
     int select_free_vc(int vnet,
-        PortDirection inport_dirn, PortDirection outport_dirn);
+        PortDirection inport_dirn, PortDirection outport_dirn,
+        bool use_escape_vc = true);
+    int get_free_credits(int vnet);
 
     inline PortDirection get_direction() { return m_direction; }
 
@@ -73,6 +73,7 @@ Router::init()
 {
     BasicRouter::init();
 
+    m_routing_unit->init();
     m_sw_alloc->init();
     m_switch->init();
 }
@@ -127,7 +128,7 @@ void
 Router::addOutPort(PortDirection outport_dirn,
                    NetworkLink *out_link,
                    const NetDest& routing_table_entry, int link_weight,
-                   CreditLink *credit_link)
+                   CreditLink *credit_link, int bypass_hops)
 {
     int port_num = m_output_unit.size();
     OutputUnit *output_unit = new OutputUnit(port_num, outport_dirn, this);
@@ -141,7 +142,12 @@ Router::addOutPort(PortDirection outport_dirn,
 
     m_routing_unit->addRoute(routing_table_entry);
     m_routing_unit->addWeight(link_weight);
-    m_routing_unit->addOutDirection(outport_dirn, port_num);
+    if (bypass_hops > 0) {
+        m_routing_unit->addExpressOutport(outport_dirn, port_num,
+                                          bypass_hops);
+    } else {
+        m_routing_unit->addOutDirection(outport_dirn, port_num);
+    }
 }
 
 PortDirection
@@ -162,6 +168,21 @@ Router::route_compute(RouteInfo route, int inport, PortDirection inport_dirn)
     return m_routing_unit->outportCompute(route, inport, inport_dirn);
 }
 
+int
+Router::escape_route_compute(RouteInfo route)
+{
+    return m_routing_unit->getEscapeOutport(route);
+}
+
+// The outports of a multicast packet, and the destinations down each
+void
+Router::multicast_route_compute(RouteInfo route, int inport,
+                                PortDirection inport_dirn,
+                                vector<pair<int, NetDest> > &branches)
+{
+    m_routing_unit->multicastCompute(route, inport, inport_dirn, branches);
+}
+
 void
 Router::grant_switch(int inport, flit *t_flit)
 {
@@ -216,21 +237,65 @@ Router::regStats()
         .name(name() + ".sw_output_arbiter_activity")
         .flags(Stats::nozero)
     ;
+
+    m_sw_chained_flits
+        .name(name() + ".sw_chained_flits")
+        .flags(Stats::nozero)
+    ;
+
+    m_sw_replicated_flits
+        .name(name() + ".sw_replicated_flits")
+        .flags(Stats::nozero)
+    ;
 }
 
 void
 Router::collateStats()
 {
+    m_buffer_reads += get_buffer_reads();
+    m_buffer_writes += get_buffer_writes();
+
+    m_sw_input_arbiter_activity = m_sw_alloc->get_input_arbiter_activity();
+    m_sw_output_arbiter_activity = m_sw_alloc->get_output_arbiter_activity();
+    m_sw_chained_flits = m_sw_alloc->get_chained_flits();
+    m_sw_replicated_flits = get_replicated_flits();
+    m_crossbar_activity = get_crossbar_activity();
+}
+
+double
+Router::get_buffer_reads()
+{
+    double reads = 0;
     for (int j = 0; j < m_virtual_networks; j++) {
         for (int i = 0; i < m_input_unit.size(); i++) {
-            m_buffer_reads += m_input_unit[i]->get_buf_read_activity(j);
-            m_buffer_writes += m_input_unit[i]->get_buf_write_activity(j);
+            reads += m_input_unit[i]->get_buf_read_activity(j);
         }
     }
+    return reads;
+}
 
-    m_sw_input_arbiter_activity = m_sw_alloc->get_input_arbiter_activity();
-    m_sw_output_arbiter_activity = m_sw_alloc->get_output_arbiter_activity();
-    m_crossbar_activity = m_switch->get_crossbar_activity();
+double
+Router::get_buffer_writes()
+{
+    double writes = 0;
+    for (int j = 0; j < m_virtual_networks; j++) {
+        for (int i = 0; i < m_input_unit.size(); i++) {
+            writes += m_input_unit[i]->get_buf_write_activity(j);
+        }
+    }
+    return writes;
+}
+
+double
+Router::get_crossbar_activity()
+{
+    return m_switch->get_crossbar_activity();
+}
+
+double
+Router::get_replicated_flits()
+{
+    return m_sw_alloc->get_replicated_flits();
 }
 
 void
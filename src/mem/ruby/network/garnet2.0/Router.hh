@@ -32,6 +32,7 @@
 #define __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_ROUTER_D_HH__
 
 #include <iostream>
+#include <utility>
 #include <vector>
 
 #include "mem/ruby/common/Consumer.hh"
@@ -66,7 +67,8 @@ class Router : public BasicRouter, public Consumer
     void addInPort(PortDirection inport_dirn, NetworkLink *link, CreditLink *credit_link);
     void addOutPort(PortDirection outport_dirn, NetworkLink *link,
                     const NetDest& routing_table_entry,
-                    int link_weight, CreditLink *credit_link);
+                    int link_weight, CreditLink *credit_link,
+                    int bypass_hops);
 
     int get_num_vcs()       { return m_num_vcs; }
     int get_num_vnets()     { return m_virtual_networks; }
@@ -87,6 +89,10 @@ class Router : public BasicRouter, public Consumer
     PortDirection getInportDirection(int inport);
 
     int route_compute(RouteInfo route, int inport, PortDirection direction);
+    int escape_route_compute(RouteInfo route);
+    void multicast_route_compute(RouteInfo route, int inport,
+        PortDirection direction,
+        std::vector<std::pair<int, NetDest> > &branches);
     void grant_switch(int inport, flit *t_flit);
     void schedule_wakeup(Cycles time);
 
@@ -95,9 +101,15 @@ class Router : public BasicRouter, public Consumer
     void printAggregateFaultProbability(std::ostream& out);
 
     void regStats();
-    void collateStats();
+    virtual void collateStats();
     void resetStats();
 
+    // Activity counters, also sampled by the NetworkHeatmap
+    double get_buffer_reads();
+    double get_buffer_writes();
+    virtual double get_crossbar_activity();
+    double get_replicated_flits();
+
     bool get_fault_vector(int temperature, float fault_vector[]){
         return m_network_ptr->fault_model->fault_vector(m_id, temperature,
                                                         fault_vector);
@@ -110,7 +122,7 @@ class Router : public BasicRouter, public Consumer
 
     uint32_t functionalWrite(Packet *);
 
-  private:
+  protected:
     int m_virtual_networks, m_num_vcs, m_vc_per_vnet;
     GarnetNetwork *m_network_ptr;
 
@@ -126,6 +138,8 @@ class Router : public BasicRouter, public Consumer
 
     Stats::Scalar m_sw_input_arbiter_activity;
     Stats::Scalar m_sw_output_arbiter_activity;
+    Stats::Scalar m_sw_chained_flits;
+    Stats::Scalar m_sw_replicated_flits;
 
     Stats::Scalar m_crossbar_activity;
 };
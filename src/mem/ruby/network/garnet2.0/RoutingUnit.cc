@@ -32,14 +32,32 @@
 
 #include "base/cast.hh"
 #include "mem/ruby/network/garnet2.0/InputUnit.hh"
+#include "mem/ruby/network/garnet2.0/OutputUnit.hh"
 #include "mem/ruby/network/garnet2.0/Router.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
 #include <vector>
+using std::make_pair;
+using std::map;
+using std::pair;
 using std::vector;
 
+// 64-bit finalizer of MurmurHash3
+static inline uint64_t
+mixHash(uint64_t key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
 RoutingUnit::RoutingUnit(Router *router)
+    : m_rng(router->get_id())
 {
     m_router = router;
+    m_ecmp_salt = 0;
     m_routing_table.clear();
     m_weight_table.clear();
 }
@@ -56,34 +74,40 @@ RoutingUnit::addWeight(int link_weight)
     m_weight_table.push_back(link_weight);
 }
 
-int
-RoutingUnit::lookupRoutingTable(NetDest msg_destination)
+void
+RoutingUnit::init()
 {
-    int output_link = -1;
-    int min_weight = INFINITE_;
-    vector<int> arr;
-    int randomIndex;
+    // Flatten the NetDest of every outport into the destination NIs it
+    // reaches, so that a route lookup does not have to intersect the
+    // message destination with every routing table entry
+    vector<vector<NodeID> > outport_dests(m_routing_table.size());
     for (int link = 0; link < m_routing_table.size(); link++) {
-        if (msg_destination.intersectionIsNotEmpty(m_routing_table[link])) {
-	  arr.push_back(link);
-            if (m_weight_table[link] >= min_weight)
-                continue;
-            output_link = link;
-            min_weight = m_weight_table[link];
-        }
+        outport_dests[link] = m_routing_table[link].getAllDest();
     }
 
-    if (output_link == -1) {
+    m_outport_lookup.build(outport_dests, m_weight_table,
+                           m_router->get_net_ptr()->getNumNodes());
+
+    // Salting the hash with the router id decorrelates the choices made
+    // at successive hops, so flows do not all pile onto the same paths
+    m_ecmp_salt = mixHash(m_router->get_net_ptr()->getECMPSeed() ^
+                          mixHash(m_router->get_id()));
+}
+
+int
+RoutingUnit::lookupRoutingTable(RouteInfo route)
+{
+    int num_candidates = m_outport_lookup.getNumCandidates(route.dest_ni);
+
+    if (num_candidates == 0) {
         fatal("Fatal Error:: No Route exists from this Router.");
         exit(0);
     }
 
-   randomIndex = rand() % arr.size();
-   return arr[randomIndex];
-    //return output_link;
+    int randomIndex = m_rng.random<int>(0, num_candidates - 1);
+    return m_outport_lookup.getCandidate(route.dest_ni, randomIndex);
 }
 
-
 void
 RoutingUnit::addInDirection(PortDirection inport_dirn, int inport_idx)
 {
@@ -98,6 +122,16 @@ RoutingUnit::addOutDirection(PortDirection outport_dirn, int outport_idx)
     m_outports_idx2dirn[outport_idx]  = outport_dirn;
 }
 
+// Express outports are kept out of the direction to outport map, which
+// direction based routing uses to find the next hop
+void
+RoutingUnit::addExpressOutport(PortDirection outport_dirn, int outport_idx,
+                               int bypass_hops)
+{
+    m_outports_idx2dirn[outport_idx] = outport_dirn;
+    m_express_outports[outport_idx] = bypass_hops;
+}
+
 int
 RoutingUnit::outportCompute(RouteInfo route, int inport, PortDirection inport_dirn)
 {
@@ -107,7 +141,7 @@ RoutingUnit::outportCompute(RouteInfo route, int inport, PortDirection inport_di
     {
         // Multiple NIs may be connected to this router, all with dirn = L_
         // Get exact outport id from table
-        outport = lookupRoutingTable(route.net_dest);
+        outport = lookupRoutingTable(route);
         return outport;
     }
 
@@ -115,18 +149,115 @@ RoutingUnit::outportCompute(RouteInfo route, int inport, PortDirection inport_di
 
     switch(routing_algorithm)
     {
-        case TABLE_:  outport = lookupRoutingTable(route.net_dest); break;
+        case TABLE_:  outport = lookupRoutingTable(route); break;
         case XY_:     outport = outportComputeXY(route, inport, inport_dirn); break;
         case RANDOM_: outport = outportComputeRandom(route, inport, inport_dirn); break;
         case TURN_MODEL_: outport = outportComputeTurnModel(route, inport, inport_dirn); break;
+        case ECMP_:   outport = outportComputeECMP(route, inport, inport_dirn); break;
+        case ADAPTIVE_: outport = outportComputeAdaptive(route, inport, inport_dirn); break;
         // any custom algorithm
         //case CUSTOM_: outportComputeCustom(); break;
-        default: outport = lookupRoutingTable(route.net_dest); break;
+        default: outport = lookupRoutingTable(route); break;
     }
 
     assert(outport != -1);
+
+    // The escape route of adaptive routing does not take express links
+    if (!m_express_outports.empty() && routing_algorithm != ADAPTIVE_)
+        outport = outportExpress(route, outport);
+
     return outport;
 }
+
+// The longest express link that goes the same way as the outport, and is
+// on a minimal path to the destination, or the outport if there is none.
+// The routing table has an express link on a minimal path when the
+// destination is at least as far along its straight path as it reaches.
+// Links whose topology gives no port directions all look alike, so they
+// never take an express link.
+int
+RoutingUnit::outportExpress(RouteInfo route, int outport)
+{
+    PortDirection outport_dirn = m_outports_idx2dirn[outport];
+    if (outport_dirn < W_ || outport_dirn > N_)
+        return outport;
+
+    int best_outport = outport;
+    int best_bypass_hops = 0;
+    map<int, int>::const_iterator it = m_express_outports.find(outport);
+    if (it != m_express_outports.end())
+        best_bypass_hops = it->second;
+
+    int num_candidates = m_outport_lookup.getNumCandidates(route.dest_ni);
+    for (int i = 0; i < num_candidates; i++) {
+        int candidate = m_outport_lookup.getCandidate(route.dest_ni, i);
+        it = m_express_outports.find(candidate);
+        if (it == m_express_outports.end() ||
+            it->second <= best_bypass_hops ||
+            m_outports_idx2dirn[candidate] != outport_dirn) {
+            continue;
+        }
+
+        best_outport = candidate;
+        best_bypass_hops = it->second;
+    }
+
+    return best_outport;
+}
+
+// Split the destinations of a multicast packet by the outport that leads
+// to each, so that the packet forks only where the paths to them diverge.
+// With table routing, a destination joins a branch that is already taken
+// if its outport is one of the candidates of the destination, which
+// keeps the tree small.
+void
+RoutingUnit::multicastCompute(RouteInfo route, int inport,
+                              PortDirection inport_dirn,
+                              vector<pair<int, NetDest> > &branches)
+{
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+    bool table_routing = (net_ptr->getRoutingAlgorithm() == TABLE_);
+
+    vector<NodeID> dests = route.net_dest.getAllDest();
+    for (int i = 0; i < dests.size(); i++) {
+        NodeID dest_ni = dests[i];
+        int branch = -1;
+
+        if (table_routing) {
+            int num_candidates = m_outport_lookup.getNumCandidates(dest_ni);
+            for (int b = 0; b < branches.size() && branch == -1; b++) {
+                for (int c = 0; c < num_candidates; c++) {
+                    if (m_outport_lookup.getCandidate(dest_ni, c) ==
+                        branches[b].first) {
+                        branch = b;
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (branch == -1) {
+            RouteInfo dest_route = route;
+            dest_route.dest_ni = dest_ni;
+            dest_route.dest_router = net_ptr->get_router_id(dest_ni);
+            dest_route.multicast = false;
+            int outport = outportCompute(dest_route, inport, inport_dirn);
+
+            for (int b = 0; b < branches.size(); b++) {
+                if (branches[b].first == outport) {
+                    branch = b;
+                    break;
+                }
+            }
+            if (branch == -1) {
+                branches.push_back(make_pair(outport, NetDest()));
+                branch = branches.size() - 1;
+            }
+        }
+
+        branches[branch].second.add(GarnetNetwork::get_machine_id(dest_ni));
+    }
+}
 /*
 int
 RoutingUnit::outportComputeGoogle(RouteInfo route,
@@ -291,3 +422,91 @@ RoutingUnit::outportComputeTurnModel(RouteInfo route,
 
     return m_outports_dirn2idx[outport_dirn];
 }
+
+/*
+ * Pick one of the minimal, smallest-weight outports towards the
+ * destination by hashing (src, dest, vnet). All packets of a flow take
+ * the same path, which keeps them in order and makes runs reproducible,
+ * while different flows spread across the equal-cost paths.
+ */
+int
+RoutingUnit::outportComputeECMP(RouteInfo route,
+                                int inport,
+                                PortDirection inport_dirn)
+{
+    int num_candidates =
+        m_outport_lookup.getNumMinWeightCandidates(route.dest_ni);
+
+    if (num_candidates == 0) {
+        fatal("Fatal Error:: No Route exists from this Router.");
+    }
+
+    if (num_candidates == 1)
+        return m_outport_lookup.getMinWeightCandidate(route.dest_ni, 0);
+
+    int idx = flowHash(route) % num_candidates;
+    return m_outport_lookup.getMinWeightCandidate(route.dest_ni, idx);
+}
+
+uint64_t
+RoutingUnit::flowHash(const RouteInfo &route) const
+{
+    uint64_t flow = ((uint64_t)route.src_ni << 40) ^
+                    ((uint64_t)route.dest_ni << 16) ^ (uint64_t)route.vnet;
+    return mixHash(flow ^ m_ecmp_salt);
+}
+
+int
+RoutingUnit::getEscapeOutport(RouteInfo route)
+{
+    int outport = m_outport_lookup.getMinWeightOutport(route.dest_ni);
+
+    if (outport == -1) {
+        fatal("Fatal Error:: No Route exists from this Router.");
+    }
+
+    return outport;
+}
+
+/*
+ * Minimal adaptive routing: among all the outports that lie on a
+ * shortest path to the destination and have a VC the packet may take,
+ * pick the one whose downstream input buffers currently have the most
+ * free credits. Deadlock freedom comes from an escape VC (the first VC
+ * of each vnet) that can only be allocated on the deterministic escape
+ * outport; see SwitchAllocator::use_escape_vc(). When no candidate has
+ * an idle VC, the packet asks for the escape outport, so that it keeps
+ * requesting the escape VC until one frees up. Ordered vnets, and
+ * networks with a single VC per vnet, always take the escape route.
+ */
+int
+RoutingUnit::outportComputeAdaptive(RouteInfo route,
+                                    int inport,
+                                    PortDirection inport_dirn)
+{
+    int escape_outport = getEscapeOutport(route);
+    int num_candidates = m_outport_lookup.getNumCandidates(route.dest_ni);
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+
+    if (num_candidates == 1 || net_ptr->isVNetOrdered(route.vnet) ||
+        net_ptr->getVCsPerVnet() < 2) {
+        return escape_outport;
+    }
+
+    // Start the scan at a flow-dependent candidate, so that ties are
+    // broken differently for different flows
+    int start = flowHash(route) % num_candidates;
+    vector<OutputUnit *> &output_unit = m_router->get_outputUnit_ref();
+
+    int outport = m_outport_lookup.getAdaptiveCandidate(route.dest_ni, start,
+        [&](int candidate) {
+            return output_unit[candidate]->has_free_vc(route.vnet,
+                inport_dirn, output_unit[candidate]->get_direction(),
+                candidate == escape_outport);
+        },
+        [&](int candidate) {
+            return output_unit[candidate]->get_free_credits(route.vnet);
+        });
+
+    return (outport == -1) ? escape_outport : outport;
+}
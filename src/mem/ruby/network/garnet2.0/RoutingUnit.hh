@@ -31,10 +31,12 @@
 #ifndef __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_ROUTING_UNIT_D_HH__
 #define __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_ROUTING_UNIT_D_HH__
 
+#include "base/random.hh"
 #include "mem/ruby/common/Consumer.hh"
 #include "mem/ruby/common/NetDest.hh"
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
 #include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
+#include "mem/ruby/network/garnet2.0/OutportLookupTable.hh"
 #include "mem/ruby/network/garnet2.0/flit.hh"
 
 class InputUnit;
@@ -44,6 +46,7 @@ class RoutingUnit
 {
   public:
     RoutingUnit(Router *router);
+    void init();
     int outportCompute(RouteInfo route,
                       int inport,
                       PortDirection inport_dirn);
@@ -51,12 +54,23 @@ class RoutingUnit
     // Topology-agnostic Routing Table based routing (default)
     void addRoute(const NetDest& routing_table_entry);
     void addWeight(int link_weight);
-    int  lookupRoutingTable(NetDest net_dest); // get output port from routing table
+    int  lookupRoutingTable(RouteInfo route); // get output port from routing table
 
     // Topology-specific direction based routing
     void addInDirection(PortDirection inport_dirn, int inport);
     void addOutDirection(PortDirection outport_dirn, int outport);
 
+    // Express links bypass the pipelines of the routers along a straight
+    // path, and are taken over the outport of the routing algorithm
+    void addExpressOutport(PortDirection outport_dirn, int outport,
+                           int bypass_hops);
+    int outportExpress(RouteInfo route, int outport);
+
+    // Outports of a multicast packet, with the destinations down each
+    void multicastCompute(RouteInfo route, int inport,
+                          PortDirection inport_dirn,
+                          std::vector<std::pair<int, NetDest> > &branches);
+
     // Routing for Mesh
     int outportComputeXY(RouteInfo route,
                          int inport,
@@ -70,14 +84,48 @@ class RoutingUnit
                                int inport,
                                PortDirection inport_dirn);
 
+    // Equal-cost multipath: hash the flow onto a minimal outport
+    int outportComputeECMP(RouteInfo route,
+                           int inport,
+                           PortDirection inport_dirn);
+
+    // Congestion-aware minimal routing with an escape VC
+    int outportComputeAdaptive(RouteInfo route,
+                               int inport,
+                               PortDirection inport_dirn);
+
+    // Deterministic route that the escape VC is restricted to
+    int getEscapeOutport(RouteInfo route);
+
+    const OutportLookupTable &
+    getOutportLookup() const
+    {
+        return m_outport_lookup;
+    }
 
   private:
+    uint64_t flowHash(const RouteInfo &route) const;
+
     Router *m_router;
 
     // Routing Table
     std::vector<NetDest> m_routing_table;
     std::vector<int> m_weight_table;
 
+    // Destination NI -> candidate outports, built from the table at init
+    OutportLookupTable m_outport_lookup;
+
+    // Per-router salt of the flow hash, derived from the ECMP seed
+    uint64_t m_ecmp_salt;
+
+    // Picks among the table candidates. Routers of different network
+    // partitions run in different threads, so each has its own
+    // generator, seeded from the router id.
+    Random m_rng;
+
+    // Express outport -> routers it bypasses
+    std::map<int, int> m_express_outports;
+
     // Inport and Outport direction to idx maps
     std::map<PortDirection, int> m_inports_dirn2idx;
     std::map<int, PortDirection> m_inports_idx2dirn;
@@ -29,6 +29,9 @@
  */
 
 #include "mem/ruby/network/garnet2.0/SwitchAllocator.hh"
+
+#include <algorithm>
+
 #include "mem/ruby/network/garnet2.0/NetworkInterface.hh"
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
@@ -53,6 +56,8 @@ SwitchAllocator::SwitchAllocator(Router *router)
 
     m_input_arbiter_activity = 0;
     m_output_arbiter_activity = 0;
+    m_chained_flits = 0;
+    m_replicated_flits = 0;
 }
 
 void
@@ -63,11 +68,24 @@ SwitchAllocator::init()
 
     m_num_inports = m_router->get_num_inports();
     m_num_outports = m_router->get_num_outports();
+    m_adaptive_routing = (m_router->get_net_ptr()->getRoutingAlgorithm() ==
+                          ADAPTIVE_) && (m_vc_per_vnet > 1);
+    m_islip = (m_router->get_net_ptr()->getSwitchAllocator() ==
+               Enums::islip);
+    m_islip_iterations = m_router->get_net_ptr()->getSwAllocIterations();
+    m_packet_chaining = m_router->get_net_ptr()->isPacketChaining();
     m_round_robin_inport.resize(m_num_outports);
     m_round_robin_invc.resize(m_num_inports);
     m_port_requests.resize(m_num_outports);
     m_vc_winners.resize(m_num_outports);
 
+    m_inport_busy.resize(m_num_inports, false);
+    m_outport_busy.resize(m_num_outports, false);
+    m_round_robin_outport.resize(m_num_inports, 0);
+    m_islip_grants.resize(m_num_outports, -1);
+    m_chain_invc.resize(m_num_inports, -1);
+    m_chain_outport.resize(m_num_inports, -1);
+
     for (int i = 0; i < m_num_inports; i++) {
         m_round_robin_invc[i] = 0;
     }
@@ -87,12 +105,50 @@ SwitchAllocator::init()
 void
 SwitchAllocator::wakeup()
 {
-    arbitrate_inports(); // First stage of allocation
-    arbitrate_outports(); // Second stage of allocation
+    fill(m_inport_busy.begin(), m_inport_busy.end(), false);
+    fill(m_outport_busy.begin(), m_outport_busy.end(), false);
+
+    // Chained packets go first, on the connections they hold
+    if (m_packet_chaining)
+        traverse_chains();
+
+    if (m_islip) {
+        allocate_islip();
+    } else {
+        arbitrate_inports(); // First stage of allocation
+        arbitrate_outports(); // Second stage of allocation
+    }
     clear_request_vector();
     check_for_wakeup();
 }
 
+// The outport requested by the flit at the head of a VC, or -1 if it
+// cannot be sent this cycle
+int
+SwitchAllocator::get_request(int inport, int invc)
+{
+    if (!m_input_unit[inport]->need_stage(invc, SA_, m_router->curCycle()))
+        return -1;
+
+    int  outport = m_input_unit[inport]->get_outport(invc);
+    int  outvc   = m_input_unit[inport]->get_outvc(invc);		 //  [ICN Project]
+
+    if (m_adaptive_routing && outvc == -1) {
+        // The head flit is still waiting for a VC: re-route
+        // it so that it can move to a less congested path
+        // or to its escape route
+        flit *t_flit = m_input_unit[inport]->peekTopFlit(invc);
+        outport = m_router->route_compute(t_flit->get_route(),
+            inport, m_input_unit[inport]->get_direction());
+        m_input_unit[inport]->grant_outport(invc, outport);
+    }
+
+    if (!send_allowed(inport, invc, outport, outvc))
+        return -1;
+
+    return outport;
+}
+
 void
 SwitchAllocator::arbitrate_inports()
 {
@@ -101,6 +157,9 @@ SwitchAllocator::arbitrate_inports()
   //  NetworkLink *inNetLink =  in_link;
  //   flit *t_flit = inNetLink->consumeLink();
     for (int inport = 0; inport < m_num_inports; inport++) {
+        if (m_inport_busy[inport])
+            continue;
+
         int invc = m_round_robin_invc[inport];
 
         // Select next round robin vc candidate within valid vnet
@@ -112,25 +171,20 @@ SwitchAllocator::arbitrate_inports()
 
         for (int invc_iter = 0; invc_iter < m_num_vcs; invc_iter++) {
 
-            if (m_input_unit[inport]->need_stage(invc, SA_, m_router->curCycle()))
+            int outport = get_request(inport, invc);
+            if (outport != -1 && !m_outport_busy[outport])
             {
-                int  outport = m_input_unit[inport]->get_outport(invc);
-                int  outvc   = m_input_unit[inport]->get_outvc(invc);		 //  [ICN Project]
-                bool make_request = send_allowed(inport, invc, outport, outvc); // [ICN Project]
-               if (make_request)	//	[ICN Project]
-                {			//	[ICN Project]
-                    m_input_arbiter_activity++;
-                    m_port_requests[outport][inport] = true;
-                    m_vc_winners[outport][inport]= invc;
-                    break; // got one vc winner for this port
-               }			//	[ICN Project]
+                m_input_arbiter_activity++;
+                m_port_requests[outport][inport] = true;
+                m_vc_winners[outport][inport]= invc;
+                break; // got one vc winner for this port
+            }
                  /*
 		Need to add code here to delete packet [ICN Project]
 		else
 		{ 
 		  delete t_flit;
 	        }*/
-            }
 
             invc++;
             if (invc >= m_num_vcs)
@@ -158,76 +212,217 @@ SwitchAllocator::arbitrate_outports()
             if (m_port_requests[outport][inport]) {
 
                 // grant this outport to this inport
-                int invc = m_vc_winners[outport][inport];
-                int outvc = m_input_unit[inport]->get_outvc(invc);
-                if (outvc == -1)
-                {
-                    // VC Allocation - select any free VC from outport
-                    outvc = vc_allocate(outport, inport, invc);
-                }
-               // [ICN Project]             
+                grant(inport, m_vc_winners[outport][inport], outport);
+                m_output_arbiter_activity++;
 
-                // remove flit from Input VC
-                flit *t_flit = m_input_unit[inport]->getTopFlit(invc);
+                // remove this request
+                m_port_requests[outport][inport] = false;
 
-                DPRINTF(RubyNetwork, "SwitchAllocator at Router %d \
-                                      granted outvc %d at outport %d \
-                                      to invc %d at inport %d at time: %lld\n",
-                        m_router->get_id(), outvc,
-                        m_router->getPortDirectionName(
-                            m_output_unit[outport]->get_direction()),
-                        invc,
-                        m_router->getPortDirectionName(
-                            m_input_unit[inport]->get_direction()),
-                        m_router->curCycle());
+                break; // got a input winner for this outport
+            }
 
+            inport++;
+            if (inport >= m_num_inports)
+                inport = 0;
+        }
+    }
+}
 
-                // flit ready for Switch Traversal
-                // the outport was already updated in the flit
-                // in the InputUnit (after route_compute)
-                t_flit->advance_stage(ST_, m_router->curCycle());
+// iSLIP: every inport requests all the outports its VCs need, each
+// outport grants one request and each inport accepts one grant, round
+// robin. The round robin pointers only move past accepted grants of the
+// first iteration, which desynchronizes them under load; the following
+// iterations match the ports left over.
+void
+SwitchAllocator::allocate_islip()
+{
+    for (int inport = 0; inport < m_num_inports; inport++) {
+        if (m_inport_busy[inport])
+            continue;
 
-                // update outport field in switch
-                // (used by switch code to send it out of correct outport
-                t_flit->set_outport(outport);
+        // One VC per outport, round robin
+        int invc = m_round_robin_invc[inport];
+        m_round_robin_invc[inport] = (invc + 1) % m_num_vcs;
 
-                // set outvc (i.e., invc for next hop) in flit
-                t_flit->set_vc(outvc);
-                m_output_unit[outport]->decrement_credit(outvc);
+        for (int invc_iter = 0; invc_iter < m_num_vcs; invc_iter++) {
+            int outport = get_request(inport, invc);
+            if (outport != -1 && !m_outport_busy[outport] &&
+                !m_port_requests[outport][inport]) {
+                m_input_arbiter_activity++;
+                m_port_requests[outport][inport] = true;
+                m_vc_winners[outport][inport] = invc;
+            }
 
-                m_router->grant_switch(inport, t_flit);
-                m_output_arbiter_activity++;
+            invc = (invc + 1) % m_num_vcs;
+        }
+    }
 
-                if ((t_flit->get_type() == TAIL_) ||
-                    t_flit->get_type() == HEAD_TAIL_) {
-
-                    // This Input VC should now be empty
-                    assert(m_input_unit[inport]->isReady(invc,
-                        m_router->curCycle()) == false);
-
-                    // Free this VC
-                    m_input_unit[inport]->set_vc_idle(invc, m_router->curCycle());
-
-                    // Send a credit back
-                    // along with the information that this VC is now idle
-                    m_input_unit[inport]->increment_credit(invc, true,
-                        m_router->curCycle());
-                } else {
-                    // Send a credit back
-                    // but do not indicate that the VC is idle
-                    m_input_unit[inport]->increment_credit(invc, false,
-                        m_router->curCycle());
+    for (int iter = 0; iter < m_islip_iterations; iter++) {
+        // Grant
+        bool granted = false;
+        for (int outport = 0; outport < m_num_outports; outport++) {
+            m_islip_grants[outport] = -1;
+            if (m_outport_busy[outport])
+                continue;
+
+            for (int i = 0; i < m_num_inports; i++) {
+                int inport = (m_round_robin_inport[outport] + i) %
+                    m_num_inports;
+                if (!m_inport_busy[inport] &&
+                    m_port_requests[outport][inport]) {
+                    m_islip_grants[outport] = inport;
+                    granted = true;
+                    break;
                 }
+            }
+        }
 
-                // remove this request
-                m_port_requests[outport][inport] = false;
-	       
-                break; // got a input winner for this outport
+        if (!granted)
+            break;
+
+        // Accept
+        for (int inport = 0; inport < m_num_inports; inport++) {
+            if (m_inport_busy[inport])
+                continue;
+
+            for (int i = 0; i < m_num_outports; i++) {
+                int outport = (m_round_robin_outport[inport] + i) %
+                    m_num_outports;
+                if (m_islip_grants[outport] != inport)
+                    continue;
+
+                if (iter == 0) {
+                    m_round_robin_inport[outport] =
+                        (inport + 1) % m_num_inports;
+                    m_round_robin_outport[inport] =
+                        (outport + 1) % m_num_outports;
+                }
+
+                grant(inport, m_vc_winners[outport][inport], outport);
+                m_output_arbiter_activity++;
+                break;
             }
+        }
+    }
+}
 
-            inport++;
-            if (inport >= m_num_inports)
-                inport = 0;
+// A packet keeps the connection its head flit was granted for as long as
+// its flits are ready to use it; a bubble gives it up.
+void
+SwitchAllocator::traverse_chains()
+{
+    for (int inport = 0; inport < m_num_inports; inport++) {
+        int invc = m_chain_invc[inport];
+        if (invc == -1)
+            continue;
+
+        int outport = m_chain_outport[inport];
+        m_chain_invc[inport] = -1;
+
+        if (m_input_unit[inport]->need_stage(invc, SA_,
+                                             m_router->curCycle()) &&
+            send_allowed(inport, invc, outport,
+                         m_input_unit[inport]->get_outvc(invc))) {
+            m_chained_flits++;
+            grant(inport, invc, outport);
+        }
+    }
+}
+
+// Send the flit at the head of an input VC to an outport
+void
+SwitchAllocator::grant(int inport, int invc, int outport)
+{
+    int outvc = m_input_unit[inport]->get_outvc(invc);
+    if (outvc == -1 && m_input_unit[inport]->is_multicast(invc))
+    {
+        // A packet that forks here takes a VC on every branch before its
+        // head flit leaves. Another inport granted this cycle may have
+        // just taken one of them: try again next cycle.
+        if (!fork_vc_allocate(inport, invc))
+            return;
+        outvc = m_input_unit[inport]->get_outvc(invc);
+    }
+    else if (outvc == -1)
+    {
+        // VC Allocation - select any free VC from outport
+        outvc = vc_allocate(outport, inport, invc);
+        if (outvc == -1)
+            return; // taken this cycle by a packet that forks here
+    }
+   // [ICN Project]             
+
+    // A multicast packet that forks here is copied to all its branches
+    // but the last, and leaves the VC with that one
+    bool multicast = m_input_unit[inport]->is_multicast(invc);
+    bool last_branch = m_input_unit[inport]->is_last_branch(invc);
+
+    // remove flit from Input VC
+    flit *t_flit = m_input_unit[inport]->getTopFlit(invc);
+
+    DPRINTF(RubyNetwork, "SwitchAllocator at Router %d \
+                          granted outvc %d at outport %d \
+                          to invc %d at inport %d at time: %lld\n",
+            m_router->get_id(), outvc,
+            m_router->getPortDirectionName(
+                m_output_unit[outport]->get_direction()),
+            invc,
+            m_router->getPortDirectionName(
+                m_input_unit[inport]->get_direction()),
+            m_router->curCycle());
+
+
+    // flit ready for Switch Traversal
+    // the outport was already updated in the flit
+    // in the InputUnit (after route_compute)
+    t_flit->advance_stage(ST_, m_router->curCycle());
+
+    // update outport field in switch
+    // (used by switch code to send it out of correct outport
+    t_flit->set_outport(outport);
+
+    // set outvc (i.e., invc for next hop) in flit
+    t_flit->set_vc(outvc);
+
+    m_output_unit[outport]->decrement_credit(outvc);
+
+    m_router->grant_switch(inport, t_flit);
+
+    m_inport_busy[inport] = true;
+    m_outport_busy[outport] = true;
+
+    if (multicast) {
+        m_input_unit[inport]->next_branch(invc);
+        if (!last_branch) {
+            m_replicated_flits++;
+            return;
+        }
+    }
+
+    if ((t_flit->get_type() == TAIL_) ||
+        t_flit->get_type() == HEAD_TAIL_) {
+
+        // This Input VC should now be empty
+        assert(m_input_unit[inport]->isReady(invc,
+            m_router->curCycle()) == false);
+
+        // Free this VC
+        m_input_unit[inport]->set_vc_idle(invc, m_router->curCycle());
+
+        // Send a credit back
+        // along with the information that this VC is now idle
+        m_input_unit[inport]->increment_credit(invc, true,
+            m_router->curCycle());
+    } else {
+        // Send a credit back
+        // but do not indicate that the VC is idle
+        m_input_unit[inport]->increment_credit(invc, false,
+            m_router->curCycle());
+
+        // The rest of the packet follows on this connection
+        if (m_packet_chaining && !multicast) {
+            m_chain_invc[inport] = invc;
+            m_chain_outport[inport] = outport;
         }
     }
 }
@@ -248,7 +443,10 @@ SwitchAllocator::send_allowed(int inport, int invc, int outport, int outvc)
 
     if (has_outvc == false) // needs outvc
     {
-        if (m_output_unit[outport]->has_free_vc(vnet, inport_dirn, outport_dirn))
+        if (m_input_unit[inport]->is_multicast(invc) ?
+            fork_vcs_available(inport, invc) :
+            m_output_unit[outport]->has_free_vc(vnet, inport_dirn,
+                outport_dirn, use_escape_vc(inport, invc, outport)))
         {
             has_outvc = true;
             has_credit = true; // each VC has at least one buffer, so no need for additional credit check
@@ -290,12 +488,68 @@ SwitchAllocator::vc_allocate(int outport, int inport, int invc)
     PortDirection outport_dirn = m_output_unit[outport]->get_direction();
 
     // Select a free VC from the output port
-    int outvc = m_output_unit[outport]->select_free_vc(get_vnet(invc), inport_dirn, outport_dirn);
-    assert(outvc != -1); // has to get a valid VC since it checked before performing SA  [ICN Project]
-    m_input_unit[inport]->grant_outvc(invc, outvc);
+    // It checked before performing SA that a VC is free, but a packet
+    // that forks here may have taken it since, in this same cycle
+    int outvc = m_output_unit[outport]->select_free_vc(get_vnet(invc),
+        inport_dirn, outport_dirn, use_escape_vc(inport, invc, outport));
+    if (outvc != -1)
+        m_input_unit[inport]->grant_outvc(invc, outvc);
     return outvc;
 }
 
+// Whether every branch of a packet that forks here has a free VC.
+// Holding the VC of one branch while waiting for that of another could
+// deadlock with a packet that forks the other way round.
+bool
+SwitchAllocator::fork_vcs_available(int inport, int invc)
+{
+    PortDirection inport_dirn = m_input_unit[inport]->get_direction();
+    int vnet = get_vnet(invc);
+
+    for (int i = 0; i < m_input_unit[inport]->get_num_branches(invc); i++) {
+        int outport = m_input_unit[inport]->get_branch_outport(invc, i);
+        if (!m_output_unit[outport]->has_free_vc(vnet, inport_dirn,
+                m_output_unit[outport]->get_direction(),
+                use_escape_vc(inport, invc, outport)))
+            return false;
+    }
+    return true;
+}
+
+// Allocate the VCs of all the branches of a packet that forks here at
+// once, or none of them
+bool
+SwitchAllocator::fork_vc_allocate(int inport, int invc)
+{
+    if (!fork_vcs_available(inport, invc))
+        return false;
+
+    PortDirection inport_dirn = m_input_unit[inport]->get_direction();
+    int vnet = get_vnet(invc);
+    vector<int> outvcs;
+
+    for (int i = 0; i < m_input_unit[inport]->get_num_branches(invc); i++) {
+        int outport = m_input_unit[inport]->get_branch_outport(invc, i);
+        outvcs.push_back(m_output_unit[outport]->select_free_vc(vnet,
+            inport_dirn, m_output_unit[outport]->get_direction(),
+            use_escape_vc(inport, invc, outport)));
+    }
+    m_input_unit[inport]->grant_branch_outvcs(invc, outvcs);
+    return true;
+}
+
+// With adaptive routing, a packet may only take the escape VC of an
+// outport that is on its deterministic escape route
+bool
+SwitchAllocator::use_escape_vc(int inport, int invc, int outport)
+{
+    if (!m_adaptive_routing)
+        return true;
+
+    flit *t_flit = m_input_unit[inport]->peekTopFlit(invc);
+    return (outport == m_router->escape_route_compute(t_flit->get_route()));
+}
+
 void
 SwitchAllocator::check_for_wakeup()
 {
@@ -303,7 +557,8 @@ SwitchAllocator::check_for_wakeup()
 
     for (int i = 0; i < m_num_inports; i++) {
         for (int j = 0; j < m_num_vcs; j++) {
-            if (m_input_unit[i]->need_stage(j, SA_, nextCycle)) {
+            if (m_input_unit[i]->need_stage(j, SA_, nextCycle) &&
+                !is_blocked(i, j)) {
                 m_router->schedule_wakeup(Cycles(1));
                 return;
             }
@@ -311,6 +566,21 @@ SwitchAllocator::check_for_wakeup()
     }
 }
 
+// A flit waiting for a downstream VC or credit does not need the router
+// to poll every cycle: the credit that unblocks it wakes the router up.
+bool
+SwitchAllocator::is_blocked(int inport, int invc)
+{
+    int outvc = m_input_unit[inport]->get_outvc(invc);
+
+    // An adaptively routed head flit may find a free VC on another path
+    if (m_adaptive_routing && outvc == -1)
+        return false;
+
+    int outport = m_input_unit[inport]->get_outport(invc);
+    return !send_allowed(inport, invc, outport, outvc);
+}
+
 int
 SwitchAllocator::get_vnet(int invc)
 {
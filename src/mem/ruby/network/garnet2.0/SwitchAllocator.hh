@@ -49,12 +49,20 @@ class SwitchAllocator : public Consumer
     void init();
     void clear_request_vector();
     void check_for_wakeup();
+    bool is_blocked(int inport, int invc);
     int get_vnet (int invc);
     void print(std::ostream& out) const {};
     void arbitrate_inports();
     void arbitrate_outports();
+    void allocate_islip();
+    void traverse_chains();
+    int get_request(int inport, int invc);
+    void grant(int inport, int invc, int outport);
     bool send_allowed(int inport, int invc, int outport, int outvc);
+    bool use_escape_vc(int inport, int invc, int outport);
     int vc_allocate(int outport, int inport, int invc);
+    bool fork_vcs_available(int inport, int invc);
+    bool fork_vc_allocate(int inport, int invc);
 
     inline double
     get_input_arbiter_activity()
@@ -66,18 +74,47 @@ class SwitchAllocator : public Consumer
     {
         return m_output_arbiter_activity;
     }
+    inline double
+    get_chained_flits()
+    {
+        return m_chained_flits;
+    }
+    inline double
+    get_replicated_flits()
+    {
+        return m_replicated_flits;
+    }
 
   private:
     int m_num_inports, m_num_outports;
     int m_num_vcs, m_vc_per_vnet;
+    bool m_adaptive_routing;
+    bool m_islip;
+    int m_islip_iterations;
+    bool m_packet_chaining;
 
     double m_input_arbiter_activity, m_output_arbiter_activity;
+    double m_chained_flits;
+    double m_replicated_flits;
 
     Router *m_router;
     std::vector<int> m_round_robin_invc;
     std::vector<int> m_round_robin_inport;
     std::vector<std::vector<bool> > m_port_requests;
     std::vector<std::vector<int> > m_vc_winners; // a list for each outport
+
+    // Ports that already move a flit this cycle
+    std::vector<bool> m_inport_busy;
+    std::vector<bool> m_outport_busy;
+
+    // iSLIP accept pointers, the grant pointers being m_round_robin_inport
+    std::vector<int> m_round_robin_outport;
+    std::vector<int> m_islip_grants; // inport granted each outport
+
+    // Packet chaining: the VC of each inport that holds its connection to
+    // an outport until the tail flit, or -1
+    std::vector<int> m_chain_invc;
+    std::vector<int> m_chain_outport;
     std::vector<InputUnit *> m_input_unit;
     std::vector<OutputUnit *> m_output_unit;
 };
@@ -0,0 +1,187 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/ruby/network/garnet2.0/TraceInjector.hh"
+
+#include "base/misc.hh"
+#include "debug/RubyNetwork.hh"
+#include "mem/ruby/common/NetDest.hh"
+#include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
+#include "mem/ruby/network/garnet2.0/NetworkInterface.hh"
+#include "mem/ruby/network/garnet2.0/TraceMessage.hh"
+
+using namespace std;
+
+TraceInjector::TraceInjector(GarnetNetwork *net_ptr,
+                             const string &filename, int window_size,
+                             int ni_queue_size)
+    : m_net_ptr(net_ptr), m_trace(filename), m_window(window_size),
+      m_window_next(0), m_window_end(0), m_ni_queue_size(ni_queue_size),
+      m_num_pending(0), m_start(0), m_last_cycle(0), m_num_read(0),
+      m_num_packets(0), m_event(this)
+{
+    fatal_if(window_size <= 0, "The trace window must hold a packet\n");
+    fatal_if(ni_queue_size <= 0, "The NI trace queues must hold a packet\n");
+
+    ProtoMessage::NetPacketHeader header;
+    if (!m_trace.read(header))
+        fatal("Failed to read the header of network trace %s\n", filename);
+
+    inform("Replaying network trace %s (%s)\n", filename, header.obj_id());
+}
+
+TraceInjector::~TraceInjector()
+{
+    if (m_event.scheduled())
+        m_net_ptr->deschedule(m_event);
+}
+
+const string
+TraceInjector::name() const
+{
+    return m_net_ptr->name() + ".trace_injector";
+}
+
+void
+TraceInjector::start()
+{
+    // The injector enqueues into the NIs directly, so they have to
+    // run on its event queue
+    for (int ni = 0; ni < m_net_ptr->getNumNodes(); ni++) {
+        if (m_net_ptr->get_ni(ni)->eventQueue() != m_net_ptr->eventQueue())
+            fatal("Network traces cannot be replayed across event queues\n");
+    }
+
+    m_pending.resize(m_net_ptr->getNumNodes() *
+                     m_net_ptr->getNumberOfVirtualNetworks());
+    m_start = m_net_ptr->curCycle();
+    m_net_ptr->schedule(m_event, m_net_ptr->clockEdge());
+}
+
+bool
+TraceInjector::refill()
+{
+    // Read in place, so that the window never reallocates
+    m_window_next = 0;
+    m_window_end = 0;
+    while (m_window_end < m_window.size() &&
+           m_trace.read(m_window[m_window_end])) {
+        m_window_end++;
+    }
+    return m_window_end > 0;
+}
+
+void
+TraceInjector::inject()
+{
+    uint64_t now = m_net_ptr->curCycle() - m_start;
+
+    // Retry the held back packets first, in trace order per NI and vnet
+    for (int i = 0; i < m_pending.size(); i++) {
+        while (!m_pending[i].empty() && inject_packet(m_pending[i].front())) {
+            m_pending[i].pop_front();
+            m_num_pending--;
+        }
+    }
+
+    int num_vnets = m_net_ptr->getNumberOfVirtualNetworks();
+    while (m_num_pending < m_window.size() &&
+           (m_window_next < m_window_end || refill())) {
+        const ProtoMessage::NetPacket &pkt = m_window[m_window_next];
+        if (pkt.cycle() > now)
+            break;
+
+        check_packet(pkt);
+
+        // Behind the packets its source already holds back, if any
+        deque<ProtoMessage::NetPacket> &pending =
+            m_pending[pkt.src() * num_vnets + pkt.vnet()];
+        if (!pending.empty() || !inject_packet(pkt)) {
+            pending.push_back(pkt);
+            m_num_pending++;
+        }
+        m_window_next++;
+    }
+
+    if (m_num_pending > 0) {
+        // Some source NI is backed up: retry next cycle
+        m_net_ptr->schedule(m_event, m_net_ptr->clockEdge(Cycles(1)));
+    } else if (m_window_next < m_window_end) {
+        uint64_t cycle = m_window[m_window_next].cycle();
+        m_net_ptr->schedule(m_event,
+            m_net_ptr->clockEdge(Cycles(cycle - now)));
+    } else {
+        inform("Network trace replay injected %d packets\n", m_num_packets);
+    }
+}
+
+// Check a packet as it is read from the window, in trace order
+void
+TraceInjector::check_packet(const ProtoMessage::NetPacket &pkt)
+{
+    int num_nodes = m_net_ptr->getNumNodes();
+    if (pkt.src() >= num_nodes || pkt.dst() >= num_nodes) {
+        fatal("Network trace packet %d goes from NI %d to NI %d, but there "
+              "are only %d NIs\n", m_num_read, pkt.src(), pkt.dst(),
+              num_nodes);
+    }
+    if (pkt.vnet() >= m_net_ptr->getNumberOfVirtualNetworks()) {
+        fatal("Network trace packet %d is on vnet %d, but there are only "
+              "%d vnets\n", m_num_read, pkt.vnet(),
+              m_net_ptr->getNumberOfVirtualNetworks());
+    }
+    if (pkt.size() == 0) {
+        fatal("Network trace packet %d has no bytes\n", m_num_read);
+    }
+    if (pkt.cycle() < m_last_cycle) {
+        fatal("Network trace packet %d at cycle %d comes after cycle %d; "
+              "the trace must be sorted by cycle\n", m_num_read,
+              pkt.cycle(), m_last_cycle);
+    }
+    m_last_cycle = pkt.cycle();
+    m_num_read++;
+}
+
+// Hand a packet to its source NI, unless the NI already holds as many
+// trace packets as it may on the vnet
+bool
+TraceInjector::inject_packet(const ProtoMessage::NetPacket &pkt)
+{
+    NetworkInterface *ni = m_net_ptr->get_ni(pkt.src());
+    if (ni->getNumTracePackets(pkt.vnet()) >= m_ni_queue_size)
+        return false;
+
+    NetDest dest;
+    dest.add(GarnetNetwork::get_machine_id(pkt.dst()));
+
+    DPRINTF(RubyNetwork, "Trace packet %d: NI %d -> NI %d, vnet %d, "
+            "%d bytes\n", m_num_packets, pkt.src(), pkt.dst(), pkt.vnet(),
+            pkt.size());
+
+    MsgPtr msg = new TraceMessage(curTick(), dest, pkt.size());
+    ni->enqueueTracePacket(msg, pkt.vnet());
+    m_num_packets++;
+    return true;
+}
@@ -0,0 +1,94 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_TRACE_INJECTOR_HH__
+#define __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_TRACE_INJECTOR_HH__
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "base/types.hh"
+#include "proto/netpacket.pb.h"
+#include "proto/protoio.hh"
+#include "sim/eventq.hh"
+
+class GarnetNetwork;
+
+/**
+ * Replays a network packet trace (see proto/netpacket.proto) into the
+ * NIs of a garnet network. Each packet is handed to its source NI at
+ * its cycle, as if the protocol had enqueued it, and dropped by its
+ * destination NI.
+ *
+ * The trace is streamed through a fixed window of packets, which is
+ * refilled when consumed, so that traces of any length replay in
+ * constant memory. For the same reason, an NI holds at most
+ * ni_queue_size trace packets per vnet. A packet that finds the queue
+ * of its source full waits in a pending queue of that NI and vnet,
+ * which is retried every cycle, while the packets of the other sources
+ * are still injected at their cycles. The replay only stops reading
+ * the trace when a window's worth of packets is pending. A backed up
+ * source thus delays its own packets, in order, but not the others.
+ */
+class TraceInjector
+{
+  public:
+    TraceInjector(GarnetNetwork *net_ptr, const std::string &filename,
+                  int window_size, int ni_queue_size);
+    ~TraceInjector();
+
+    // Schedule the first packet; trace cycles count from here
+    void start();
+
+    const std::string name() const;
+
+  private:
+    void inject();
+    bool refill();
+    void check_packet(const ProtoMessage::NetPacket &pkt);
+    bool inject_packet(const ProtoMessage::NetPacket &pkt);
+
+    GarnetNetwork *m_net_ptr;
+    ProtoInputStream m_trace;
+
+    std::vector<ProtoMessage::NetPacket> m_window;
+    int m_window_next;
+    int m_window_end;
+    int m_ni_queue_size;
+
+    // Packets due but held back by a full NI, per source NI and vnet
+    std::vector<std::deque<ProtoMessage::NetPacket> > m_pending;
+    int m_num_pending;
+
+    Cycles m_start;
+    uint64_t m_last_cycle;
+    uint64_t m_num_read;
+    uint64_t m_num_packets;
+
+    EventWrapper<TraceInjector, &TraceInjector::inject> m_event;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_TRACE_INJECTOR_HH__
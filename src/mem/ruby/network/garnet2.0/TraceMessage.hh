@@ -0,0 +1,70 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_TRACE_MESSAGE_HH__
+#define __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_TRACE_MESSAGE_HH__
+
+#include <iostream>
+
+#include "mem/ruby/common/NetDest.hh"
+#include "mem/ruby/slicc_interface/Message.hh"
+
+// A packet replayed from a network trace. It only lives in the network:
+// the source NI flitisizes it and the destination NI drops it, so the
+// protocol never sees it.
+class TraceMessage : public Message
+{
+  public:
+    TraceMessage(Tick curTime, const NetDest &dest, int size)
+        : Message(curTime), m_dest(dest), m_size(size)
+    { }
+
+    MsgPtr
+    clone() const
+    {
+        return new TraceMessage(*this);
+    }
+
+    void
+    print(std::ostream& out) const
+    {
+        out << "[TraceMessage: dest=" << m_dest << " size=" << m_size << "]";
+    }
+
+    const NetDest& getDestination() const { return m_dest; }
+    NetDest& getDestination() { return m_dest; }
+
+    // Size in bytes
+    int getSize() const { return m_size; }
+
+    bool functionalRead(Packet *pkt) { return false; }
+    bool functionalWrite(Packet *pkt) { return false; }
+
+  private:
+    NetDest m_dest;
+    int m_size;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_TRACE_MESSAGE_HH__
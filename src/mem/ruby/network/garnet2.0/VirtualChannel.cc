@@ -39,6 +39,7 @@ VirtualChannel::VirtualChannel(int id)
     m_vc_state.second = Cycles(0);
     m_output_vc = -1;
     m_output_port = -1;
+    m_branch = 0;
 }
 
 VirtualChannel::~VirtualChannel()
@@ -54,6 +55,8 @@ VirtualChannel::set_idle(Cycles curTime)
     m_enqueue_time = Cycles(INFINITE_);
     m_output_port = -1;
     m_output_vc = -1;
+    m_branches.clear();
+    m_branch = 0;
 }
 
 void
@@ -76,8 +79,59 @@ VirtualChannel::need_stage(flit_stage stage, Cycles time)
     return false;
 }
 
+void
+VirtualChannel::add_branch(int outport, const RouteInfo &route, MsgPtr msg)
+{
+    if (m_branches.empty())
+        m_output_port = outport;
+
+    Branch branch = {outport, -1, route, msg};
+    m_branches.push_back(branch);
+}
+
+void
+VirtualChannel::set_branch_outvcs(const std::vector<int> &outvcs)
+{
+    assert(outvcs.size() == m_branches.size());
+    for (int i = 0; i < m_branches.size(); i++)
+        m_branches[i].outvc = outvcs[i];
+    m_output_vc = outvcs[m_branch];
+}
+
+void
+VirtualChannel::next_branch()
+{
+    m_branches[m_branch].outvc = m_output_vc;
+    m_branch = (m_branch + 1) % m_branches.size();
+    m_output_port = m_branches[m_branch].outport;
+    m_output_vc = m_branches[m_branch].outvc;
+}
+
+// The flit at the head of the VC, as it is sent down the current branch:
+// it carries the destinations of the branch, and a copy of the message
+// that is addressed to them
+flit*
+VirtualChannel::getBranchFlit()
+{
+    const Branch &branch = m_branches[m_branch];
+    flit *t_flit;
+    if (m_branch + 1 < m_branches.size())
+        t_flit = new flit(*m_input_buffer->peekTopFlit());
+    else
+        t_flit = m_input_buffer->getTopFlit();
+
+    t_flit->set_route(branch.route);
+    t_flit->get_msg_ptr() = branch.msg;
+    return t_flit;
+}
+
 uint32_t
 VirtualChannel::functionalWrite(Packet *pkt)
 {
-    return m_input_buffer->functionalWrite(pkt);
+    uint32_t num_functional_writes = m_input_buffer->functionalWrite(pkt);
+    for (int i = 0; i < m_branches.size(); i++) {
+        if (m_branches[i].msg->functionalWrite(pkt))
+            num_functional_writes++;
+    }
+    return num_functional_writes;
 }
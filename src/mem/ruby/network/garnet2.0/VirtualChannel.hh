@@ -32,6 +32,7 @@
 #define __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_VIRTUAL_CHANNEL_D_HH__
 
 #include <utility>
+#include <vector>
 
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
 #include "mem/ruby/network/garnet2.0/flitBuffer.hh"
@@ -81,18 +82,58 @@ class VirtualChannel
     inline flit*
     getTopFlit()
     {
-        return m_input_buffer->getTopFlit();
+        if (m_branches.empty())
+            return m_input_buffer->getTopFlit();
+        return getBranchFlit();
     }
 
+    // A multicast packet that forks at this router is sent down each of
+    // its branches in turn, a flit at a time. The flit at the head of the
+    // VC is copied to all but the last branch, and leaves with the last.
+    // The output VCs of all the branches are allocated together.
+    void add_branch(int outport, const RouteInfo &route, MsgPtr msg);
+    inline bool is_multicast() { return !m_branches.empty(); }
+    inline int get_num_branches() { return m_branches.size(); }
+
+    inline int
+    get_branch_outport(int branch)
+    {
+        return m_branches[branch].outport;
+    }
+
+    void set_branch_outvcs(const std::vector<int> &outvcs);
+
+    inline bool
+    is_last_branch()
+    {
+        return m_branch + 1 >= m_branches.size();
+    }
+
+    void next_branch();
+
     uint32_t functionalWrite(Packet *pkt);
 
   private:
+    flit *getBranchFlit();
+
+    struct Branch
+    {
+        int outport;
+        int outvc;
+        RouteInfo route;
+        MsgPtr msg;
+    };
+
     int m_id;
     flitBuffer *m_input_buffer;
     std::pair<VC_state_type, Cycles> m_vc_state;
     int m_output_port;
     Cycles m_enqueue_time;
     int m_output_vc;
+
+    // The outport and outvc above are those of the current branch
+    std::vector<Branch> m_branches;
+    int m_branch;
 };
 
 #endif // __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_VIRTUAL_CHANNEL_D_HH__
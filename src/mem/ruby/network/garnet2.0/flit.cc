@@ -30,6 +30,37 @@
 
 #include "mem/ruby/network/garnet2.0/flit.hh"
 
+#include <vector>
+
+// Storage of deleted flits, ready for reuse. Flits move between event
+// queues, and so threads, so each thread keeps its own list. A thread
+// that frees more flits than it creates, such as one that only holds
+// destination NIs, gives the excess back to the heap beyond
+// MaxFreeFlits, so that its list does not grow forever.
+static thread_local std::vector<void *> flitFreeList;
+static const size_t MaxFreeFlits = 1024;
+
+void *
+flit::operator new(size_t size)
+{
+    if (size != sizeof(flit) || flitFreeList.empty())
+        return ::operator new(size);
+
+    void *p = flitFreeList.back();
+    flitFreeList.pop_back();
+    return p;
+}
+
+void
+flit::operator delete(void *p, size_t size)
+{
+    if (size != sizeof(flit) || flitFreeList.size() >= MaxFreeFlits) {
+        ::operator delete(p);
+        return;
+    }
+    flitFreeList.push_back(p);
+}
+
 flit::flit(int id, int  vc, int vnet, RouteInfo route, int size, MsgPtr msg_ptr,
     Cycles curTime)
 {
@@ -93,6 +93,11 @@ class flit
 
     bool functionalWrite(Packet *pkt);
 
+    // Flits and credits are created and destroyed at a high rate, so
+    // freed ones are recycled through a freelist
+    static void *operator new(size_t size);
+    static void operator delete(void *p, size_t size);
+
   private:
     int m_id;
     int m_vnet;
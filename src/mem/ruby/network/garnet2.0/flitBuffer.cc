@@ -32,24 +32,28 @@
 
 flitBuffer::flitBuffer()
 {
+    m_head = 0;
+    m_is_heap = false;
     max_size = INFINITE_;
 }
 
 flitBuffer::flitBuffer(int maximum_size)
 {
+    m_head = 0;
+    m_is_heap = false;
     max_size = maximum_size;
 }
 
 bool
 flitBuffer::isEmpty()
 {
-    return (m_buffer.size() == 0);
+    return (m_buffer.size() == m_head);
 }
 
 bool
 flitBuffer::isReady(Cycles curTime)
 {
-    if (m_buffer.size() != 0 ) {
+    if (!isEmpty()) {
         flit *t_flit = peekTopFlit();
         if (t_flit->get_time() <= curTime)
             return true;
@@ -60,13 +64,13 @@ flitBuffer::isReady(Cycles curTime)
 void
 flitBuffer::print(std::ostream& out) const
 {
-    out << "[flitBuffer: " << m_buffer.size() << "] " << std::endl;
+    out << "[flitBuffer: " << m_buffer.size() - m_head << "] " << std::endl;
 }
 
 bool
 flitBuffer::isFull()
 {
-    return (m_buffer.size() >= max_size);
+    return (m_buffer.size() - m_head >= max_size);
 }
 
 void
@@ -80,7 +84,7 @@ flitBuffer::functionalWrite(Packet *pkt)
 {
     uint32_t num_functional_writes = 0;
 
-    for (unsigned int i = 0; i < m_buffer.size(); ++i) {
+    for (unsigned int i = m_head; i < m_buffer.size(); ++i) {
         if (m_buffer[i]->functionalWrite(pkt)) {
             num_functional_writes++;
         }
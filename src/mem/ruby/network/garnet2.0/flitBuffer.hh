@@ -53,21 +53,52 @@ class flitBuffer
     flit *
     getTopFlit()
     {
-        flit *f = m_buffer.front();
-        std::pop_heap(m_buffer.begin(), m_buffer.end(), flit::greater);
-        m_buffer.pop_back();
+        flit *f;
+        if (m_is_heap) {
+            f = m_buffer.front();
+            std::pop_heap(m_buffer.begin(), m_buffer.end(), flit::greater);
+            m_buffer.pop_back();
+            if (m_buffer.empty())
+                m_is_heap = false;
+        } else {
+            f = m_buffer[m_head++];
+            if (m_head == m_buffer.size()) {
+                m_buffer.clear();
+                m_head = 0;
+            }
+        }
         return f;
     }
 
     flit *
     peekTopFlit()
     {
-        return m_buffer.front();
+        return m_buffer[m_head];
     }
 
     void
     insert(flit *flt)
     {
+        if (!m_is_heap) {
+            // Flits almost always arrive in time order: keep them in a
+            // FIFO as long as they do
+            if (isEmpty() || !flit::greater(m_buffer.back(), flt)) {
+                if (m_head >= 16 && 2 * m_head >= m_buffer.size()) {
+                    m_buffer.erase(m_buffer.begin(),
+                                   m_buffer.begin() + m_head);
+                    m_head = 0;
+                }
+                m_buffer.push_back(flt);
+                return;
+            }
+
+            // Out of order, fall back to a heap until the buffer drains
+            m_buffer.erase(m_buffer.begin(), m_buffer.begin() + m_head);
+            m_head = 0;
+            std::make_heap(m_buffer.begin(), m_buffer.end(), flit::greater);
+            m_is_heap = true;
+        }
+
         m_buffer.push_back(flt);
         std::push_heap(m_buffer.begin(), m_buffer.end(), flit::greater);
     }
@@ -75,7 +106,10 @@ class flitBuffer
     uint32_t functionalWrite(Packet *pkt);
 
   private:
+    // A FIFO starting at m_head, or a heap (with m_head == 0)
     std::vector<flit *> m_buffer;
+    size_t m_head;
+    bool m_is_heap;
     int max_size;
 };
 
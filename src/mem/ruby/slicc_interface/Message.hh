@@ -30,17 +30,21 @@
 #define __MEM_RUBY_SLICC_INTERFACE_MESSAGE_HH__
 
 #include <iostream>
-#include <memory>
 #include <stack>
 
+#include "base/refcnt.hh"
 #include "mem/packet.hh"
 #include "mem/protocol/MessageSizeType.hh"
 #include "mem/ruby/common/NetDest.hh"
 
 class Message;
-typedef std::shared_ptr<Message> MsgPtr;
 
-class Message
+// Messages are only handled by the thread of the controllers and network
+// that pass them on, so their reference count is not atomic, and it is
+// kept in the message rather than in a separately allocated block
+typedef RefCountingPtr<Message> MsgPtr;
+
+class Message : public RefCounted
 {
   public:
     Message(Tick curTime)
@@ -49,8 +53,10 @@ class Message
           m_DelayedTicks(0), m_msg_counter(0)
     { }
 
+    // The copy has no references yet
     Message(const Message &other)
-        : m_time(other.m_time),
+        : RefCounted(),
+          m_time(other.m_time),
           m_LastEnqueueTime(other.m_LastEnqueueTime),
           m_DelayedTicks(other.m_DelayedTicks),
           m_msg_counter(other.m_msg_counter)
@@ -0,0 +1,129 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_RUBY_SLICC_INTERFACE_MESSAGE_SLAB_HH__
+#define __MEM_RUBY_SLICC_INTERFACE_MESSAGE_SLAB_HH__
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+/**
+ * Slab allocator of the messages of type T, which the class operator new
+ * and operator delete of T forward to. Messages are created and destroyed
+ * at a high rate, so freed ones are recycled through a per-type freelist,
+ * which is refilled a slab of messages at a time. The memory is kept for
+ * the life of the simulation. Objects of a derived type, which have
+ * another size, are not pooled.
+ *
+ * The freelists are per thread. With a partitioned network, messages
+ * are often freed by another thread than the one that allocated them,
+ * so a freelist that grows past MaxFree hands a slab's worth of
+ * messages to a shared list, which the freelists refill from before
+ * allocating new slabs. The memory thus stays bounded by the peak
+ * number of live messages, whatever the traffic between threads.
+ */
+template <class T>
+class MessageSlab
+{
+  public:
+    static void *
+    allocate(size_t size)
+    {
+        if (size != sizeof(T))
+            return ::operator new(size);
+
+        if (freeList.empty())
+            refill();
+
+        void *p = freeList.back();
+        freeList.pop_back();
+        return p;
+    }
+
+    static void
+    deallocate(void *p, size_t size)
+    {
+        if (size != sizeof(T)) {
+            ::operator delete(p);
+            return;
+        }
+        freeList.push_back(p);
+        if (freeList.size() > MaxFree)
+            release();
+    }
+
+  private:
+    static const int SlabSize = 64;
+    static const size_t MaxFree = 4 * SlabSize;
+
+    static void
+    refill()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sharedLock);
+            for (int i = 0; i < SlabSize && !sharedList.empty(); i++) {
+                freeList.push_back(sharedList.back());
+                sharedList.pop_back();
+            }
+        }
+        if (!freeList.empty())
+            return;
+
+        char *slab = static_cast<char *>(::operator new(SlabSize * sizeof(T)));
+        for (int i = SlabSize - 1; i >= 0; i--)
+            freeList.push_back(slab + i * sizeof(T));
+    }
+
+    static void
+    release()
+    {
+        std::lock_guard<std::mutex> lock(sharedLock);
+        for (int i = 0; i < SlabSize; i++) {
+            sharedList.push_back(freeList.back());
+            freeList.pop_back();
+        }
+    }
+
+    // A message may be freed by another thread than the one that
+    // allocated it, in which case its memory moves to that freelist
+    static thread_local std::vector<void *> freeList;
+
+    // Messages handed back by the freelists that grew too long
+    static std::vector<void *> sharedList;
+    static std::mutex sharedLock;
+};
+
+template <class T>
+thread_local std::vector<void *> MessageSlab<T>::freeList;
+
+template <class T>
+std::vector<void *> MessageSlab<T>::sharedList;
+
+template <class T>
+std::mutex MessageSlab<T>::sharedLock;
+
+#endif // __MEM_RUBY_SLICC_INTERFACE_MESSAGE_SLAB_HH__
@@ -36,6 +36,7 @@
 #include "mem/protocol/RubyAccessMode.hh"
 #include "mem/protocol/RubyRequestType.hh"
 #include "mem/ruby/common/Address.hh"
+#include "mem/ruby/slicc_interface/MessageSlab.hh"
 
 class RubyRequest : public Message
 {
@@ -71,7 +72,12 @@ class RubyRequest : public Message
 
     RubyRequest(Tick curTime) : Message(curTime) {}
     MsgPtr clone() const
-    { return std::shared_ptr<Message>(new RubyRequest(*this)); }
+    { return new RubyRequest(*this); }
+
+    static void *operator new(size_t size)
+    { return MessageSlab<RubyRequest>::allocate(size); }
+    static void operator delete(void *p, size_t size)
+    { MessageSlab<RubyRequest>::deallocate(p, size); }
 
     Addr getLineAddress() const { return m_LineAddress; }
     Addr getPhysicalAddress() const { return m_PhysicalAddress; }
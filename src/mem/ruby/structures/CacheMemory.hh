@@ -31,7 +31,6 @@
 #define __MEM_RUBY_STRUCTURES_CACHEMEMORY_HH__
 
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "base/statistics.hh"
@@ -158,6 +157,13 @@ class CacheMemory : public SimObject
     int findTagInSet(int64_t line, Addr tag) const;
     int findTagInSetIgnorePermissions(int64_t cacheSet, Addr tag) const;
 
+    // index of a way of a set in m_cache and m_tags
+    int64_t
+    entryIndex(int64_t cacheSet, int loc) const
+    {
+        return cacheSet * m_cache_assoc + loc;
+    }
+
     // Private copy constructor and assignment operator
     CacheMemory(const CacheMemory& obj);
     CacheMemory& operator=(const CacheMemory& obj);
@@ -166,10 +172,12 @@ class CacheMemory : public SimObject
     // Data Members (m_prefix)
     bool m_is_instruction_only_cache;
 
-    // The first index is the # of cache lines.
-    // The second index is the the amount associativity.
-    std::unordered_map<Addr, int> m_tag_index;
-    std::vector<std::vector<AbstractCacheEntry*> > m_cache;
+    // The entries, and the line address of each, set after set. A way
+    // that holds no line has no entry and an invalid tag, which no line
+    // address matches.
+    static const Addr InvalidTag = MaxAddr;
+    std::vector<AbstractCacheEntry*> m_cache;
+    std::vector<Addr> m_tags;
 
     AbstractReplacementPolicy *m_replacementPolicy_ptr;
 
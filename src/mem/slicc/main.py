@@ -64,6 +64,8 @@ def main(args=None):
                       help="print traceback on error")
     parser.add_option("-q", "--quiet",
                       help="don't print messages")
+    parser.add_option("-T", "--transition-table", action='store_true',
+                      help="dispatch transitions through a dense table")
     opts,files = parser.parse_args(args=args)
 
     if len(files) != 1:
@@ -75,7 +77,8 @@ def main(args=None):
     output("SLICC v0.4")
     output("Parsing...")
 
-    slicc = SLICC(files[0], verbose=True, debug=opts.debug, traceback=opts.tb)
+    slicc = SLICC(files[0], verbose=True, debug=opts.debug, traceback=opts.tb,
+                  transition_table=opts.transition_table)
 
     if opts.print_files:
         for i in sorted(slicc.files()):
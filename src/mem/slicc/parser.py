@@ -38,10 +38,14 @@ import slicc.util as util
 from slicc.symbols import SymbolTable
 
 class SLICC(Grammar):
-    def __init__(self, filename, base_dir, verbose=False, traceback=False, **kwargs):
+    def __init__(self, filename, base_dir, verbose=False, traceback=False,
+                 transition_table=False, **kwargs):
         self.protocol = None
         self.traceback = traceback
         self.verbose = verbose
+        # Dispatch the transitions through a dense [state][event] table
+        # of function pointers instead of a switch
+        self.transition_table = transition_table
         self.symtab = SymbolTable(self)
         self.base_dir = base_dir
 
@@ -358,6 +358,39 @@ TransitionResult doTransitionWorker(${ident}_Event event,
 
         code('''
                                     Addr addr);
+''')
+
+        if self.symtab.slicc.transition_table:
+            resources, actions, indices = self.transitionTable()
+            params = self.transitionActionsParams()
+            code('''
+
+// Dense [state][event] transition table. The resource checks and the
+// actions of a transition are member functions shared by all the
+// transitions with the same code; NULL actions mark an invalid one.
+typedef TransitionResult
+    (${ident}_Controller::*TransitionResourcesFn)(Addr addr);
+typedef TransitionResult
+    (${ident}_Controller::*TransitionActionsFn)($params);
+
+struct TransitionTableEntry
+{
+    TransitionResourcesFn resources;
+    TransitionActionsFn actions;
+    ${ident}_State next_state;
+    bool next_state_wildcard;
+};
+
+static const TransitionTableEntry
+    m_transition_table[${ident}_State_NUM][${ident}_Event_NUM];
+
+''')
+            for i in range(len(resources)):
+                code('TransitionResult transitionResources$i(Addr addr);')
+            for i in range(len(actions)):
+                code('TransitionResult transitionActions$i($params);')
+
+        code('''
 
 int m_counters[${ident}_State_NUM][${ident}_Event_NUM];
 int m_event_counters[${ident}_Event_NUM];
@@ -1242,6 +1275,14 @@ ${ident}_Controller::doTransitionWorker(${ident}_Event event,
         code('''
                                         Addr addr)
 {
+''')
+
+        if self.symtab.slicc.transition_table:
+            self.printTransitionTable(code)
+            code.write(path, "%s_Transitions.cc" % self.ident)
+            return
+
+        code('''
     switch(HASH_FUN(state, event)) {
 ''')
 
@@ -1267,61 +1308,8 @@ ${ident}_Controller::doTransitionWorker(${ident}_Event event,
                     ns_ident = trans.nextState.ident
                     case('next_state = ${ident}_State_${ns_ident};')
 
-            actions = trans.actions
-            request_types = trans.request_types
-
-            # Check for resources
-            case_sorter = []
-            res = trans.resources
-            for key,val in res.iteritems():
-                val = '''
-if (!%s.areNSlotsAvailable(%s, clockEdge()))
-    return TransitionResult_ResourceStall;
-''' % (key.code, val)
-                case_sorter.append(val)
-
-            # Check all of the request_types for resource constraints
-            for request_type in request_types:
-                val = '''
-if (!checkResourceAvailable(%s_RequestType_%s, addr)) {
-    return TransitionResult_ResourceStall;
-}
-''' % (self.ident, request_type.ident)
-                case_sorter.append(val)
-
-            # Emit the code sequences in a sorted order.  This makes the
-            # output deterministic (without this the output order can vary
-            # since Map's keys() on a vector of pointers is not deterministic
-            for c in sorted(case_sorter):
-                case("$c")
-
-            # Record access types for this transition
-            for request_type in request_types:
-                case('recordRequestType(${ident}_RequestType_${{request_type.ident}}, addr);')
-
-            # Figure out if we stall
-            stall = False
-            for action in actions:
-                if action.ident == "z_stall":
-                    stall = True
-                    break
-
-            if stall:
-                case('return TransitionResult_ProtocolStall;')
-            else:
-                if self.TBEType != None and self.EntryType != None:
-                    for action in actions:
-                        case('${{action.ident}}(m_tbe_ptr, m_cache_entry_ptr, addr);')
-                elif self.TBEType != None:
-                    for action in actions:
-                        case('${{action.ident}}(m_tbe_ptr, addr);')
-                elif self.EntryType != None:
-                    for action in actions:
-                        case('${{action.ident}}(m_cache_entry_ptr, addr);')
-                else:
-                    for action in actions:
-                        case('${{action.ident}}(addr);')
-                case('return TransitionResult_Valid;')
+            self.printTransitionResources(case, trans)
+            self.printTransitionActions(case, trans)
 
             case = str(case)
 
@@ -1352,6 +1340,213 @@ if (!checkResourceAvailable(%s_RequestType_%s, addr)) {
 ''')
         code.write(path, "%s_Transitions.cc" % self.ident)
 
+    def printTransitionResources(self, code, trans):
+        '''Resource checks of a transition'''
+        request_types = trans.request_types
+
+        # Check for resources
+        checks = []
+        res = trans.resources
+        for key,val in res.iteritems():
+            val = '''
+if (!%s.areNSlotsAvailable(%s, clockEdge()))
+    return TransitionResult_ResourceStall;
+''' % (key.code, val)
+            checks.append(val)
+
+        # Check all of the request_types for resource constraints
+        for request_type in request_types:
+            val = '''
+if (!checkResourceAvailable(%s_RequestType_%s, addr)) {
+    return TransitionResult_ResourceStall;
+}
+''' % (self.ident, request_type.ident)
+            checks.append(val)
+
+        # Emit the code sequences in a sorted order.  This makes the
+        # output deterministic (without this the output order can vary
+        # since Map's keys() on a vector of pointers is not deterministic
+        for c in sorted(checks):
+            code('$c')
+
+    def printTransitionActions(self, code, trans):
+        '''Actions of a transition, once its resources are available'''
+        ident = self.ident
+        actions = trans.actions
+        request_types = trans.request_types
+
+        # Record access types for this transition
+        for request_type in request_types:
+            code('recordRequestType(${ident}_RequestType_${{request_type.ident}}, addr);')
+
+        # Figure out if we stall
+        stall = False
+        for action in actions:
+            if action.ident == "z_stall":
+                stall = True
+                break
+
+        if stall:
+            code('return TransitionResult_ProtocolStall;')
+        else:
+            if self.TBEType != None and self.EntryType != None:
+                for action in actions:
+                    code('${{action.ident}}(m_tbe_ptr, m_cache_entry_ptr, addr);')
+            elif self.TBEType != None:
+                for action in actions:
+                    code('${{action.ident}}(m_tbe_ptr, addr);')
+            elif self.EntryType != None:
+                for action in actions:
+                    code('${{action.ident}}(m_cache_entry_ptr, addr);')
+            else:
+                for action in actions:
+                    code('${{action.ident}}(addr);')
+            code('return TransitionResult_Valid;')
+
+    def transitionActionsParams(self):
+        '''Parameters of the transition actions in the dense table'''
+        params = []
+        if self.TBEType != None:
+            params.append('%s*& m_tbe_ptr' % self.TBEType.c_ident)
+        if self.EntryType != None:
+            params.append('%s*& m_cache_entry_ptr' % self.EntryType.c_ident)
+        params.append('Addr addr')
+        return ', '.join(params)
+
+    def transitionTable(self):
+        '''Unique resource checks and actions of the transitions, each
+        numbered in the order of the transitions, and per (state, event)
+        the numbers of its own (None when it checks no resources)'''
+        resources = orderdict()
+        actions = orderdict()
+        indices = {}
+
+        for trans in self.transitions:
+            res = self.symtab.codeFormatter()
+            self.printTransitionResources(res, trans)
+            res = str(res)
+            if res and res not in resources:
+                resources[res] = len(resources)
+
+            act = self.symtab.codeFormatter()
+            self.printTransitionActions(act, trans)
+            act = str(act)
+            if act not in actions:
+                actions[act] = len(actions)
+
+            indices[(trans.state, trans.event)] = \
+                (resources[res] if res else None, actions[act])
+
+        return resources, actions, indices
+
+    def printTransitionTable(self, code):
+        '''Output the dense transition table in place of the switch'''
+        ident = self.ident
+        resources, actions, indices = self.transitionTable()
+        params = self.transitionActionsParams()
+        args = ', '.join([p.split()[-1] for p in params.split(', ')])
+
+        code('''
+    const TransitionTableEntry &trans = m_transition_table[state][event];
+    if (trans.actions == NULL) {
+        panic("Invalid transition\\n"
+              "%s time: %d addr: %s event: %s state: %s\\n",
+              name(), curCycle(), addr, event, state);
+    }
+
+''')
+        # getNextState only exists in machines with * end states
+        wildcard = False
+        for trans in self.transitions:
+            if trans.nextState.isWildcard():
+                wildcard = True
+
+        if wildcard:
+            code('''
+    if (trans.next_state_wildcard) {
+        next_state = getNextState(addr);
+    } else {
+        next_state = trans.next_state;
+    }
+''')
+        else:
+            code('    next_state = trans.next_state;')
+
+        code('''
+
+    if (trans.resources != NULL) {
+        TransitionResult result = (this->*trans.resources)(addr);
+        if (result != TransitionResult_Valid) {
+            return result;
+        }
+    }
+
+    return (this->*trans.actions)($args);
+}
+''')
+
+        for res,i in resources.iteritems():
+            code('''
+
+TransitionResult
+${ident}_Controller::transitionResources$i(Addr addr)
+{
+''')
+            code.indent()
+            code('$res')
+            code('return TransitionResult_Valid;')
+            code.dedent()
+            code('}')
+
+        for act,i in actions.iteritems():
+            code('''
+
+TransitionResult
+${ident}_Controller::transitionActions$i($params)
+{
+''')
+            code.indent()
+            code('$act')
+            code.dedent()
+            code('}')
+
+        # The states and events are in the order of their enums
+        code('''
+
+const ${ident}_Controller::TransitionTableEntry
+${ident}_Controller::m_transition_table[${ident}_State_NUM][${ident}_Event_NUM] = {
+''')
+        code.indent()
+        for state in self.states.itervalues():
+            code('{ // ${ident}_State_${{state.ident}}')
+            code.indent()
+            for event in self.events.itervalues():
+                if (state, event) not in indices:
+                    code('{ NULL, NULL, ${ident}_State_${{state.ident}}, false '
+                         '}, // ${{event.ident}}')
+                    continue
+
+                trans = self.table[(state, event)]
+                res, act = indices[(state, event)]
+                if res is None:
+                    res_fn = 'NULL'
+                else:
+                    res_fn = '&%s_Controller::transitionResources%d' % \
+                        (ident, res)
+                act_fn = '&%s_Controller::transitionActions%d' % (ident, act)
+
+                if trans.nextState.isWildcard():
+                    next_state, wild = state.ident, 'true'
+                else:
+                    next_state, wild = trans.nextState.ident, 'false'
+
+                code('{ $res_fn, $act_fn,')
+                code('  ${ident}_State_${next_state}, $wild }, // ${{event.ident}}')
+            code.dedent()
+            code('},')
+        code.dedent()
+        code('};')
+
 
     # **************************
     # ******* HTML Files *******
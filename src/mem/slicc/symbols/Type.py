@@ -203,6 +203,9 @@ class Type(Symbol):
             code('#include "mem/protocol/$0.hh"', self["interface"])
             parent = " :  public %s" % self["interface"]
 
+        if self.isMessage:
+            code('#include "mem/ruby/slicc_interface/MessageSlab.hh"')
+
         code('''
 $klass ${{self.c_ident}}$parent
 {
@@ -281,7 +284,20 @@ $klass ${{self.c_ident}}$parent
 MsgPtr
 clone() const
 {
-     return std::shared_ptr<Message>(new ${{self.c_ident}}(*this));
+     return new ${{self.c_ident}}(*this);
+}
+
+// Messages are allocated from a slab of their type
+static void *
+operator new(size_t size)
+{
+    return MessageSlab<${{self.c_ident}}>::allocate(size);
+}
+
+static void
+operator delete(void *p, size_t size)
+{
+    MessageSlab<${{self.c_ident}}>::deallocate(p, size);
 }
 ''')
         else:
@@ -0,0 +1,115 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "mem/ruby/common/LogHistogram.hh"
+#include "unittest/unittest.hh"
+
+using namespace std;
+
+int
+main()
+{
+    UnitTest::setCase("Empty");
+    {
+        LogHistogram hist;
+        EXPECT_EQ(hist.samples(), 0);
+        EXPECT_EQ(hist.percentile(0.5), 0);
+    }
+
+    UnitTest::setCase("Buckets are contiguous");
+    {
+        EXPECT_EQ(LogHistogram::bucket(0), 0);
+        EXPECT_EQ(LogHistogram::bucketLow(0), 0);
+        for (int b = 0; b < LogHistogram::NumBuckets - 1; b++) {
+            EXPECT_EQ(LogHistogram::bucketHigh(b) + 1,
+                      LogHistogram::bucketLow(b + 1));
+            EXPECT_EQ(LogHistogram::bucket(LogHistogram::bucketLow(b)), b);
+            EXPECT_EQ(LogHistogram::bucket(LogHistogram::bucketHigh(b)), b);
+        }
+        EXPECT_EQ(LogHistogram::bucket(1ULL << 40),
+                  LogHistogram::NumBuckets - 1);
+    }
+
+    UnitTest::setCase("Small values are exact");
+    {
+        for (uint64_t v = 0; v < LogHistogram::SubBuckets; v++) {
+            EXPECT_EQ(LogHistogram::bucketLow(LogHistogram::bucket(v)), v);
+            EXPECT_EQ(LogHistogram::bucketHigh(LogHistogram::bucket(v)), v);
+        }
+    }
+
+    UnitTest::setCase("Percentiles match a sorted reference");
+    {
+        srand(1);
+        LogHistogram hist;
+        vector<uint64_t> reference;
+        for (int i = 0; i < 100000; i++) {
+            // Mostly short latencies, with a long tail
+            uint64_t v = rand() % 50;
+            if (rand() % 100 == 0)
+                v += rand() % 5000;
+            hist.sample(v);
+            reference.push_back(v);
+        }
+        sort(reference.begin(), reference.end());
+        EXPECT_EQ(hist.samples(), reference.size());
+
+        double ps[] = { 0.0, 0.5, 0.9, 0.99, 0.999, 1.0 };
+        for (double p : ps) {
+            size_t rank = max<size_t>(1, ceil(p * reference.size()));
+            uint64_t exact = reference[rank - 1];
+            uint64_t approx = hist.percentile(p);
+            // Rounded up to the end of the bucket of the exact value
+            EXPECT_EQ(approx,
+                      LogHistogram::bucketHigh(LogHistogram::bucket(exact)));
+            EXPECT_TRUE(approx >= exact);
+            EXPECT_TRUE(approx - exact <= exact / LogHistogram::SubBuckets);
+        }
+    }
+
+    UnitTest::setCase("Add and reset");
+    {
+        LogHistogram a, b;
+        for (int i = 0; i < 10; i++)
+            a.sample(1);
+        for (int i = 0; i < 10; i++)
+            b.sample(1000);
+        a.add(b);
+        EXPECT_EQ(a.samples(), 20);
+        EXPECT_EQ(a.percentile(0.5), 1);
+        EXPECT_EQ(a.percentile(0.55),
+                  LogHistogram::bucketHigh(LogHistogram::bucket(1000)));
+
+        a.reset();
+        EXPECT_EQ(a.samples(), 0);
+        EXPECT_EQ(a.count(LogHistogram::bucket(1)), 0);
+    }
+
+    return UnitTest::printResults();
+}
@@ -0,0 +1,197 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdlib>
+#include <vector>
+
+#include "mem/ruby/network/garnet2.0/OutportLookupTable.hh"
+#include "unittest/unittest.hh"
+
+using namespace std;
+
+/*
+ * Reference implementation: the linear scan over every routing table
+ * entry that RoutingUnit::lookupRoutingTable used to do for each route.
+ */
+static void
+linearScan(const vector<vector<bool> > &table, const vector<int> &weights,
+           NodeID dest, vector<int> &candidates, int &min_outport)
+{
+    int min_weight = 10000;
+    candidates.clear();
+    min_outport = -1;
+    for (int link = 0; link < table.size(); link++) {
+        if (table[link][dest]) {
+            candidates.push_back(link);
+            if (weights[link] >= min_weight)
+                continue;
+            min_outport = link;
+            min_weight = weights[link];
+        }
+    }
+}
+
+static bool
+matchesLinearScan(const vector<vector<bool> > &table,
+                  const vector<int> &weights, int num_nodes)
+{
+    vector<vector<NodeID> > outport_dests(table.size());
+    for (int link = 0; link < table.size(); link++) {
+        for (NodeID dest = 0; dest < num_nodes; dest++) {
+            if (table[link][dest])
+                outport_dests[link].push_back(dest);
+        }
+    }
+
+    OutportLookupTable lookup;
+    lookup.build(outport_dests, weights, num_nodes);
+    if (lookup.getNumNodes() != num_nodes)
+        return false;
+
+    for (NodeID dest = 0; dest < num_nodes; dest++) {
+        vector<int> candidates;
+        int min_outport;
+        linearScan(table, weights, dest, candidates, min_outport);
+
+        if (lookup.getNumCandidates(dest) != candidates.size())
+            return false;
+        for (int i = 0; i < candidates.size(); i++) {
+            if (lookup.getCandidate(dest, i) != candidates[i])
+                return false;
+            if (lookup.getCandidateWeight(dest, i) != weights[candidates[i]])
+                return false;
+        }
+        if (lookup.getMinWeightOutport(dest) != min_outport)
+            return false;
+
+        // Every candidate sharing the smallest weight, in outport order
+        vector<int> min_candidates;
+        for (int outport : candidates) {
+            if (weights[outport] == weights[min_outport])
+                min_candidates.push_back(outport);
+        }
+        if (lookup.getNumMinWeightCandidates(dest) != min_candidates.size())
+            return false;
+        for (int i = 0; i < min_candidates.size(); i++) {
+            if (lookup.getMinWeightCandidate(dest, i) != min_candidates[i])
+                return false;
+        }
+    }
+    return true;
+}
+
+int
+main()
+{
+    UnitTest::setCase("Empty table");
+    {
+        OutportLookupTable lookup;
+        lookup.build(vector<vector<NodeID> >(), vector<int>(), 4);
+        EXPECT_EQ(lookup.getNumNodes(), 4);
+        EXPECT_EQ(lookup.getNumCandidates(2), 0);
+        EXPECT_EQ(lookup.getMinWeightOutport(2), -1);
+    }
+
+    UnitTest::setCase("Edge switch with multiple uplinks");
+    {
+        // Two local ports (NIs 0 and 1) and two equal-cost uplinks that
+        // both reach the remaining NIs, plus a heavier third uplink
+        const int num_nodes = 6;
+        vector<vector<bool> > table(5, vector<bool>(num_nodes, false));
+        table[0][0] = true;
+        table[1][1] = true;
+        for (int dest = 2; dest < num_nodes; dest++) {
+            table[2][dest] = true;
+            table[3][dest] = true;
+            table[4][dest] = true;
+        }
+        vector<int> weights = { 1, 1, 2, 2, 3 };
+        EXPECT_TRUE(matchesLinearScan(table, weights, num_nodes));
+
+        vector<vector<NodeID> > dests = { {0}, {1}, {2, 3, 4, 5},
+                                          {2, 3, 4, 5}, {2, 3, 4, 5} };
+        OutportLookupTable lookup;
+        lookup.build(dests, weights, num_nodes);
+        EXPECT_EQ(lookup.getNumCandidates(0), 1);
+        EXPECT_EQ(lookup.getCandidate(0, 0), 0);
+        EXPECT_EQ(lookup.getNumCandidates(5), 3);
+        EXPECT_EQ(lookup.getCandidate(5, 0), 2);
+        EXPECT_EQ(lookup.getCandidate(5, 2), 4);
+        EXPECT_EQ(lookup.getMinWeightOutport(5), 2);
+        EXPECT_EQ(lookup.getNumMinWeightCandidates(5), 2);
+        EXPECT_EQ(lookup.getMinWeightCandidate(5, 1), 3);
+    }
+
+    UnitTest::setCase("Adaptive candidate needs an idle VC");
+    {
+        // Destination 0 is reachable through outports 1, 2 and 3
+        vector<vector<NodeID> > dests = { {}, {0}, {0}, {0} };
+        OutportLookupTable lookup;
+        lookup.build(dests, vector<int>(4, 1), 1);
+
+        // Outport 3 has the most credits but all its VCs are held by
+        // other packets: it must not be picked
+        vector<bool> idle_vc = { false, true, true, false };
+        vector<int> credits = { 0, 2, 3, 8 };
+        auto has_free_vc = [&](int outport) { return idle_vc[outport]; };
+        auto free_credits = [&](int outport) { return credits[outport]; };
+        EXPECT_EQ(lookup.getAdaptiveCandidate(0, 0, has_free_vc,
+                                              free_credits), 2);
+        EXPECT_EQ(lookup.getAdaptiveCandidate(0, 2, has_free_vc,
+                                              free_credits), 2);
+
+        // Ties go to the first candidate visited from start
+        credits[1] = 3;
+        EXPECT_EQ(lookup.getAdaptiveCandidate(0, 0, has_free_vc,
+                                              free_credits), 1);
+        EXPECT_EQ(lookup.getAdaptiveCandidate(0, 1, has_free_vc,
+                                              free_credits), 2);
+
+        // No candidate with an idle VC: the caller takes the escape route
+        idle_vc = { false, false, false, false };
+        EXPECT_EQ(lookup.getAdaptiveCandidate(0, 0, has_free_vc,
+                                              free_credits), -1);
+    }
+
+    UnitTest::setCase("Random routing tables");
+    {
+        srand(0x5eed);
+        for (int iter = 0; iter < 200; iter++) {
+            int num_nodes = 1 + rand() % 128;
+            int num_outports = 1 + rand() % 16;
+            vector<vector<bool> > table(num_outports,
+                                        vector<bool>(num_nodes, false));
+            vector<int> weights(num_outports);
+            for (int link = 0; link < num_outports; link++) {
+                weights[link] = 1 + rand() % 4;
+                for (int dest = 0; dest < num_nodes; dest++)
+                    table[link][dest] = (rand() % 3) == 0;
+            }
+            EXPECT_TRUE(matchesLinearScan(table, weights, num_nodes));
+        }
+    }
+
+    return UnitTest::printResults();
+}
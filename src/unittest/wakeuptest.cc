@@ -0,0 +1,106 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdlib>
+#include <set>
+
+#include "mem/ruby/common/ScheduledWakeups.hh"
+#include "unittest/unittest.hh"
+
+using namespace std;
+
+static bool
+matches(const ScheduledWakeups &wakeups, const set<Tick> &reference,
+        Tick from, Tick to)
+{
+    if (wakeups.size() != reference.size())
+        return false;
+    for (Tick t = from; t < to; t++) {
+        if (wakeups.contains(t) != (reference.count(t) != 0))
+            return false;
+    }
+    return true;
+}
+
+int
+main()
+{
+    UnitTest::setCase("Empty");
+    {
+        ScheduledWakeups wakeups;
+        EXPECT_TRUE(wakeups.empty());
+        EXPECT_FALSE(wakeups.contains(0));
+        wakeups.removeBefore(100);
+        EXPECT_TRUE(wakeups.empty());
+    }
+
+    UnitTest::setCase("Ordered and out of order inserts");
+    {
+        ScheduledWakeups wakeups;
+        wakeups.insert(1000);
+        wakeups.insert(3000);
+        wakeups.insert(2000);
+        wakeups.insert(3000);
+        wakeups.insert(500);
+        EXPECT_EQ(wakeups.size(), 4);
+        EXPECT_TRUE(wakeups.contains(500));
+        EXPECT_TRUE(wakeups.contains(2000));
+        EXPECT_FALSE(wakeups.contains(2500));
+
+        wakeups.removeBefore(2000);
+        EXPECT_EQ(wakeups.size(), 2);
+        EXPECT_FALSE(wakeups.contains(1000));
+        EXPECT_TRUE(wakeups.contains(2000));
+
+        wakeups.removeBefore(3001);
+        EXPECT_TRUE(wakeups.empty());
+    }
+
+    UnitTest::setCase("Random schedules against std::set");
+    {
+        srand(0x5eed);
+        ScheduledWakeups wakeups;
+        set<Tick> reference;
+        Tick now = 0;
+        for (int iter = 0; iter < 20000; iter++) {
+            int op = rand() % 8;
+            if (op < 5) {
+                Tick t = now + (rand() % 64) * 10;
+                wakeups.insert(t);
+                reference.insert(t);
+            } else if (op < 7) {
+                now += (rand() % 8) * 10;
+                wakeups.removeBefore(now);
+                reference.erase(reference.begin(),
+                                reference.lower_bound(now));
+            } else {
+                EXPECT_TRUE(matches(wakeups, reference, now, now + 640));
+            }
+        }
+        EXPECT_TRUE(matches(wakeups, reference, now, now + 640));
+    }
+
+    return UnitTest::printResults();
+}
@@ -0,0 +1,104 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Throughput of the wakeup bookkeeping done by Consumer on every
+ * scheduleEventAbsolute(), with the std::set it used to keep and with
+ * ScheduledWakeups.
+ */
+
+#include <csignal>
+#include <set>
+#include <unistd.h>
+
+#include "base/cprintf.hh"
+#include "mem/ruby/common/ScheduledWakeups.hh"
+
+using namespace std;
+
+volatile int stop = false;
+
+void
+handle_alarm(int signal)
+{
+    stop = true;
+}
+
+void
+do_test(int seconds)
+{
+    stop = false;
+    alarm(seconds);
+}
+
+// Each cycle schedules a few wakeups up to four cycles ahead, as a
+// router or message buffer does
+static const Tick period = 500;
+static const Tick offsets[] = { 1, 1, 2, 1, 4, 1, 3, 1 };
+
+int
+main()
+{
+    long iterations = 0;
+    Tick now = 0;
+
+    signal(SIGALRM, handle_alarm);
+
+    set<Tick> tree;
+    do_test(10);
+    while (!stop) {
+        Tick t = now + offsets[iterations & 7] * period;
+        if (tree.find(t) == tree.end())
+            tree.insert(t);
+        tree.erase(tree.begin(), tree.lower_bound(now));
+
+        if ((iterations & 3) == 3)
+            now += period;
+        iterations += 1;
+    }
+
+    cprintf("completed %d schedules with std::set in 10s, "
+            "%f schedules/s\n", iterations, iterations / 10.0);
+
+    iterations = 0;
+    now = 0;
+    ScheduledWakeups wakeups;
+    do_test(10);
+    while (!stop) {
+        Tick t = now + offsets[iterations & 7] * period;
+        if (!wakeups.contains(t))
+            wakeups.insert(t);
+        wakeups.removeBefore(now);
+
+        if ((iterations & 3) == 3)
+            now += period;
+        iterations += 1;
+    }
+
+    cprintf("completed %d schedules with ScheduledWakeups in 10s, "
+            "%f schedules/s\n", iterations, iterations / 10.0);
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+#!/usr/bin/env python
+
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# This script converts an ASCII network packet trace to the protobuf
+# format replayed by garnet2.0 (--network-trace). It assumes that protoc
+# has been executed and already generated the Python package for the
+# network packet messages. This can be done manually using:
+# protoc --python_out=. --proto_path=src/proto src/proto/netpacket.proto
+#
+# The ASCII trace format uses one line per packet on the format cycle,
+# src, dst, vnet, size, with the lines sorted by cycle. For example:
+# 10,0,5,0,8
+# 12,3,1,2,72
+# This trace sends 8 bytes from NI 0 to NI 5 on vnet 0 at cycle 10,
+# then 72 bytes from NI 3 to NI 1 on vnet 2 at cycle 12. The output is
+# written as it is read, so traces of any size can be converted.
+
+import protolib
+import sys
+
+# Import the network packet proto definitions. If they are not found,
+# attempt to generate them automatically. This assumes that the script
+# is executed from the gem5 root.
+try:
+    import netpacket_pb2
+except:
+    print "Did not find network packet proto definitions, attempting to " \
+          "generate"
+    from subprocess import call
+    error = call(['protoc', '--python_out=util', '--proto_path=src/proto',
+                  'src/proto/netpacket.proto'])
+    if not error:
+        print "Generated network packet proto definitions"
+
+        try:
+            import google.protobuf
+        except:
+            print "Please install the Python protobuf module"
+            exit(-1)
+
+        import netpacket_pb2
+    else:
+        print "Failed to import network packet proto definitions"
+        exit(-1)
+
+def main():
+    if len(sys.argv) != 3:
+        print "Usage: ", sys.argv[0], " <ASCII input> <protobuf output>"
+        exit(-1)
+
+    try:
+        ascii_in = open(sys.argv[1], 'r')
+    except IOError:
+        print "Failed to open ", sys.argv[1], " for reading"
+        exit(-1)
+
+    try:
+        proto_out = open(sys.argv[2], 'wb')
+    except IOError:
+        print "Failed to open ", sys.argv[2], " for writing"
+        exit(-1)
+
+    # Write the magic number in 4-byte Little Endian, similar to what
+    # is done in src/proto/protoio.cc
+    proto_out.write("gem5")
+
+    # Add the network packet header
+    header = netpacket_pb2.NetPacketHeader()
+    header.obj_id = "Converted ASCII trace " + sys.argv[1]
+    protolib.encodeMessage(proto_out, header)
+
+    # For each line in the ASCII trace, create a network packet message
+    # and write it to the encoded output
+    for line in ascii_in:
+        cycle, src, dst, vnet, size = line.split(',')
+        packet = netpacket_pb2.NetPacket()
+        packet.cycle = long(cycle)
+        packet.src = int(src)
+        packet.dst = int(dst)
+        packet.vnet = int(vnet)
+        packet.size = int(size)
+        protolib.encodeMessage(proto_out, packet)
+
+    # We're done
+    ascii_in.close()
+    proto_out.close()
+
+if __name__ == "__main__":
+    main()